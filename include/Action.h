@@ -9,6 +9,8 @@ namespace panda
 		Left,
 		Right,
 		Use,
+		ToggleOverlay,
+		Hint,
 		None,
 		Exit
 	};
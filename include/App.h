@@ -19,7 +19,11 @@ namespace panda
 		void setState(State state);
 		State state() const;
 
+		void setOverlayVisible(bool visible);
+		bool overlayVisible() const;
+
 	private:
 		State m_state = State::Game;
+		bool m_overlayVisible = false;
 	};
 }
\ No newline at end of file
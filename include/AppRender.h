@@ -3,6 +3,7 @@
 #include "AppControl.h"
 #include "GameRender.h"
 #include "MenuRender.h"
+#include "PerfOverlayRender.h"
 #include "Render.h"
 
 namespace panda
@@ -14,13 +15,17 @@ namespace panda
 		{
 			GameRender& gameRender;
 			MenuRender& menuRender;
+			PerfOverlayRender& overlayRender;
 		};
 
-		AppRender(const App& app, Renders renders);
+		AppRender(const App& app, Renders renders, Console& console);
+
+		// Draws a whole frame, the overlay goes on top of the game or menu
 		void update() override;
 
 	private:
 		const App& m_app;
 		Renders m_renders;
+		Console& m_console;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace panda
+{
+	/// Memory resource handing out a fixed buffer front to back, memory is only given back when it was the last allocation
+	/// Allocations that don't fit go to the upstream resource. Both are counted, so what is built in the arena can be watched
+	class Arena : public std::pmr::memory_resource
+	{
+	public:
+		Arena(void* buffer, size_t size, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+		/// Deleted copy constructor, containers keep a pointer to the arena
+		Arena(const Arena& arena) = delete;
+
+		/// Bytes of the buffer handed out, including alignment padding
+		size_t used() const { return m_used; }
+
+		/// Size of the buffer
+		size_t capacity() const { return m_size; }
+
+		/// Bytes taken from the upstream resource and not yet freed, because the buffer was full
+		size_t overflow() const { return m_overflow; }
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+		std::byte* m_buffer;
+		size_t m_size;
+		size_t m_used = 0;
+		size_t m_overflow = 0;
+		std::pmr::memory_resource* m_upstream;
+	};
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace panda
+{
+	/// Queue between pipeline stages, producers block while it is full so a slow stage holds back the ones before it
+	/// Once closed, consumers drain what is left then get empty results
+	template <class T>
+	class BoundedQueue
+	{
+	public:
+		explicit BoundedQueue(size_t capacity)
+			: m_capacity(capacity == 0 ? 1 : capacity)
+		{
+		}
+
+		BoundedQueue(const BoundedQueue& queue) = delete;
+
+		/// Blocks until there is room, returns false if the queue was closed
+		bool push(T item)
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_notFull.wait(lock, [this]() { return m_items.size() < m_capacity || m_closed; });
+			if (m_closed)
+				return false;
+			m_items.push_back(std::move(item));
+			m_notEmpty.notify_one();
+			return true;
+		}
+
+		/// Blocks until an item is available, empty once the queue is closed and drained
+		std::optional<T> pop()
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_notEmpty.wait(lock, [this]() { return !m_items.empty() || m_closed; });
+			if (m_items.empty())
+				return std::nullopt;
+			T item = std::move(m_items.front());
+			m_items.pop_front();
+			m_notFull.notify_one();
+			return item;
+		}
+
+		/// No more items will be pushed, wakes every waiting consumer
+		void close()
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_closed = true;
+			m_notEmpty.notify_all();
+			m_notFull.notify_all();
+		}
+
+	private:
+		std::deque<T> m_items;
+		size_t m_capacity;
+		std::mutex m_mutex;
+		std::condition_variable m_notEmpty;
+		std::condition_variable m_notFull;
+		bool m_closed = false;
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "Card.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace panda
+{
+	/// Set of the 52 cards of a deck, one bit per card, ordered by suit then number
+	/// Bit operations answer position wide questions at once, like every closed ace: closed & numberSet(1)
+	using CardSet = uint64_t;
+
+	/// Number of distinct cards, the range of cardId
+	constexpr size_t cardCount = 52;
+
+	/// Returns the index of the card in the deck, cardCount for cards without a valid number
+	inline size_t cardId(const Card& card)
+	{
+		if (card.number < 1 || card.number > 13)
+			return cardCount;
+		return static_cast<size_t>(card.suit) * 13 + static_cast<size_t>(card.number - 1);
+	}
+
+	/// Returns the card with the index in the deck, open
+	inline Card cardFromId(size_t id) { return Card(static_cast<int>(id % 13) + 1, static_cast<Card::Suit>(id / 13)); }
+
+	/// Returns the bit of the card, cards without a valid number are not part of any set
+	inline CardSet cardBit(const Card& card)
+	{
+		size_t id = cardId(card);
+		return id == cardCount ? 0 : CardSet(1) << id;
+	}
+
+	/// Returns the set of the four cards of the number
+	constexpr CardSet numberSet(int number)
+	{
+		return number < 1 || number > 13 ? 0 : (CardSet(1) | CardSet(1) << 13 | CardSet(1) << 26 | CardSet(1) << 39) << (number - 1);
+	}
+
+	/// Returns the set of the thirteen cards of the suit
+	constexpr CardSet suitSet(Card::Suit suit) { return CardSet(0x1FFF) << (static_cast<int>(suit) * 13); }
+
+	/// Index of the lowest set bit, the value must not be zero
+	inline size_t lowestBit(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, value);
+		return index;
+#else
+		return static_cast<size_t>(__builtin_ctzll(value));
+#endif
+	}
+
+	/// Index of the highest set bit, the value must not be zero
+	inline size_t highestBit(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return index;
+#else
+		return 63 - static_cast<size_t>(__builtin_clzll(value));
+#endif
+	}
+
+	/// Number of set bits
+	inline size_t bitCount(uint64_t value)
+	{
+#if defined(_MSC_VER)
+		// __popcnt64 needs a CPU check, the portable version is only a few operations
+		value = value - ((value >> 1) & 0x5555555555555555ull);
+		value = (value & 0x3333333333333333ull) + ((value >> 2) & 0x3333333333333333ull);
+		value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return static_cast<size_t>((value * 0x0101010101010101ull) >> 56);
+#else
+		return static_cast<size_t>(__builtin_popcountll(value));
+#endif
+	}
+
+	/// Mask of the bits below count, count can be up to 64
+	constexpr uint64_t lowBits(size_t count) { return count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1; }
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "Card.h"
+#include "CardSet.h"
 
+#include <cstddef>
+#include <memory_resource>
 #include <optional>
 #include <vector>
 
@@ -9,15 +12,26 @@ namespace panda
 	class CardStack
 	{
 	public:
-		explicit CardStack(std::vector<Card>&& cards = {});
+		using allocator_type = std::pmr::polymorphic_allocator<Card>;
 
-		// Takes all cards after index, including index
+		explicit CardStack(std::pmr::vector<Card>&& cards = {});
+
+		// Copies and moves the stack with its cards in the memory of the allocator
+		// Containers of stacks with a polymorphic allocator pass theirs on through these
+		CardStack(const CardStack& other, const allocator_type& allocator);
+		CardStack(CardStack&& other, const allocator_type& allocator);
+		CardStack(const CardStack& other) = default;
+		CardStack(CardStack&& other) = default;
+		CardStack& operator=(const CardStack& other) = default;
+		CardStack& operator=(CardStack&& other) = default;
+
+		// Takes all cards after index, including index, into a stack allocated from the allocator
 		// Returns empty optional if no cards can be taken
-		std::optional<CardStack> take(size_t index);
+		std::optional<CardStack> take(size_t index, const allocator_type& allocator = {});
 
-		// Takes top card of stack
+		// Takes top card of stack, into a stack allocated from the allocator
 		// Returns empty optional if no cards can be taken
-		std::optional<CardStack> takeTop();
+		std::optional<CardStack> takeTop(const allocator_type& allocator = {});
 
 		// Returns the card at the bottom of the stack, under the rest of the cards
 		std::optional<Card> bottom() const;
@@ -26,13 +40,31 @@ namespace panda
 		std::optional<Card> top() const;
 
 		// Returns the index of the card at the top, first card to be visible
-		size_t topIndex() const;
+		size_t topIndex() const { return m_cards.size() - 1; }
 
-		// Returns the index of the first open card, if any
+		// Returns the index of the first open card, if any, in constant time for the first 64 cards
 		std::optional<size_t> firstOpenCard() const;
 
+		// Returns if the card at the index is open
+		bool isOpen(size_t index) const;
+
+		// Returns the number of open cards from the index to the top
+		size_t openCount(size_t firstCardIndex = 0) const;
+
+		// Returns the number of open cards on top of the stack, down to the first closed card
+		size_t openRunLength() const;
+
+		// Returns the set of cards in the stack, with two decks a card stays in the set while any copy is left
+		CardSet cardSet() const { return m_cardSet; }
+
+		// Returns the set of cards in the stack that are open
+		CardSet openCardSet() const { return m_openCardSet; }
+
+		// Returns if the card is in the stack, open or closed
+		bool contains(const Card& card) const { return (m_cardSet & cardBit(card)) != 0; }
+
 		// Returns all the cards in the stack
-		const std::vector<Card>& cards() const;
+		const std::pmr::vector<Card>& cards() const { return m_cards; }
 
 		// Appends stack at the end of the current stack
 		// Returns false if operation fails
@@ -48,9 +80,32 @@ namespace panda
 		void flipTop();
 
 		// Number of cards in stack
-		size_t size() const;
+		size_t size() const { return m_cards.size(); }
+
+	private:
+		// Rebuilds the open mask and the card sets from the cards
+		void rebuildMasks();
+
+		// Returns if no card is in the stack twice, so bits can be cleared without a rescan
+		bool hasUniqueCards() const { return bitCount(m_cardSet) == m_cards.size(); }
+
+		std::pmr::vector<Card> m_cards;
+		uint64_t m_openMask = 0;    // bit i is set when card i is open, cards from 64 on are scanned instead
+		CardSet m_cardSet = 0;
+		CardSet m_openCardSet = 0;
+	};
+
+	/// Memory on the call stack for cards that only pass through on their way to another stack, as with take and append
+	/// Holds two decks, anything beyond goes to the heap
+	class MoveBuffer : public std::pmr::monotonic_buffer_resource
+	{
+	public:
+		MoveBuffer()
+			: std::pmr::monotonic_buffer_resource(m_buffer, sizeof(m_buffer))
+		{
+		}
 
 	private:
-		std::vector<Card> m_cards;
+		alignas(Card) std::byte m_buffer[2 * cardCount * sizeof(Card)];
 	};
 }
\ No newline at end of file
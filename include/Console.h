@@ -1,10 +1,19 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace panda
 {
+	/// Counters of the last finished frame, between begin and end
+	struct ConsoleStats
+	{
+		size_t cellsWritten = 0;       // characters drawn by draw calls
+		size_t bytesFlushed = 0;       // bytes handed to the console backend, including clears
+		size_t inputQueueDepth = 0;    // input events waiting to be read
+	};
+
 	class Console
 	{
 	public:
@@ -17,6 +26,12 @@ namespace panda
 		/// Ends drawing character
 		virtual void end() = 0;
 
+		/// Starts drawing on top of the displayed frame, without clearing it
+		virtual void beginUpdate() = 0;
+
+		/// Ends drawing on top of the displayed frame
+		virtual void endUpdate() = 0;
+
 		/// Returns the console width
 		virtual int width() const = 0;
 
@@ -30,7 +45,7 @@ namespace panda
 		virtual void setDrawColor(int fgColor) = 0;
 
 		/// Draws the given string at row, column
-		virtual void draw(const std::string& str, int x, int y) const = 0;
+		virtual void draw(std::string_view str, int x, int y) const = 0;
 
 		/// Draws the given char at row, column
 		virtual void draw(char text, int x, int y) const = 0;
@@ -43,5 +58,8 @@ namespace panda
 
 		/// Clears the console from all output
 		virtual void clear() = 0;
+
+		/// Returns the counters of the last finished frame
+		virtual ConsoleStats stats() const = 0;
 	};
 }
\ No newline at end of file
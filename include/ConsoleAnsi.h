@@ -0,0 +1,79 @@
+#pragma once
+#include "Console.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+namespace panda
+{
+	/// Console drawing into a grid of cells, each finished frame is encoded as the ANSI sequences that turn the last sent frame into it
+	/// Only changed cells are sent, so an unchanged frame costs no bytes. Code page 437 characters are sent as UTF-8
+	/// Colors are the Windows console attributes used by the renders, mapped to the 16 ANSI colors
+	class ConsoleAnsi : public Console
+	{
+	public:
+		/// The cell grids and the output are allocated from the memory resource
+		ConsoleAnsi(int width = 80, int height = 40, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		void setClearColor(int color) override;
+		void begin() override;
+		void end() override;
+		void beginUpdate() override;
+		void endUpdate() override;
+		int width() const override;
+		int height() const override;
+		void setDrawColor(int fgColor, int bgColor) override;
+		void setDrawColor(int fgColor) override;
+		void draw(std::string_view str, int x, int y) const override;
+		void draw(char text, int x, int y) const override;
+		void drawRect(int x, int y, int width, int heigth) const override;
+		void drawRectOutline(int x, int y, int width, int height, bool fill = true) const override;
+		void clear() override;
+		ConsoleStats stats() const override;
+
+		/// Bytes encoded since the last consume, to be sent to the terminal
+		const std::pmr::string& output() const { return m_output; }
+
+		/// Drops the first bytes of the output once they are sent
+		void consume(size_t bytes);
+
+		/// Forgets what the terminal shows, the next frame is sent whole
+		void invalidate();
+
+		/// Encodes the whole screen the terminal shows after the encoded frames, for a terminal that starts watching late
+		std::string keyframe() const;
+
+	private:
+		struct Cell
+		{
+			char text = ' ';
+			uint8_t color = 0;    // foreground in the low four bits, background in the high ones
+
+			bool operator==(const Cell& other) const { return text == other.text && color == other.color; }
+			bool operator!=(const Cell& other) const { return !(*this == other); }
+		};
+
+		void put(char text, int x, int y) const;
+		void encodeChanges();
+
+		// Appends the sequences that turn the shown cells into the given ones, every cell is written when nothing is shown
+		template <class String>
+		void encodeCells(String& out, const std::pmr::vector<Cell>& cells, const std::pmr::vector<Cell>* shown) const;
+
+		int m_width;
+		int m_height;
+		int m_fgColor = 0xF;
+		int m_bgColor = 0x0;
+		int m_clearColor = 0x0;
+
+		// frame being drawn and the frame the terminal shows
+		mutable std::pmr::vector<Cell> m_back;
+		std::pmr::vector<Cell> m_front;
+		std::pmr::string m_output;
+
+		mutable ConsoleStats m_frameStats;
+		ConsoleStats m_lastFrameStats;
+	};
+}
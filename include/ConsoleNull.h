@@ -0,0 +1,36 @@
+#pragma once
+#include "Console.h"
+
+namespace panda
+{
+	/// Console that discards all output, for headless runs and benchmarks
+	class ConsoleNull : public Console
+	{
+	public:
+		ConsoleNull(int width = 120, int height = 60);
+
+		void setClearColor(int color) override;
+		void begin() override;
+		void end() override;
+		void beginUpdate() override;
+		void endUpdate() override;
+		int width() const override;
+		int height() const override;
+		void setDrawColor(int fgColor, int bgColor) override;
+		void setDrawColor(int fgColor) override;
+		void draw(std::string_view str, int x, int y) const override;
+		void draw(char text, int x, int y) const override;
+		void drawRect(int x, int y, int width, int heigth) const override;
+		void drawRectOutline(int x, int y, int width, int height, bool fill = true) const override;
+		void clear() override;
+		ConsoleStats stats() const override;
+
+	private:
+		int m_width;
+		int m_height;
+
+		// Counts cells like a real console would, so headless runs report the same draw stats
+		mutable ConsoleStats m_frameStats;
+		ConsoleStats m_lastFrameStats;
+	};
+}
@@ -20,6 +20,12 @@ namespace panda
 		/// Ends drawing character
 		void end() override;
 
+		/// Starts drawing on top of the displayed frame, without clearing it
+		void beginUpdate() override;
+
+		/// Ends drawing on top of the displayed frame
+		void endUpdate() override;
+
 		/// Returns the console width
 		int width() const override;
 
@@ -33,7 +39,7 @@ namespace panda
 		void setDrawColor(int fgColor) override;
 
 		/// Draws the given string at row, column
-		void draw(const std::string& str, int x, int y) const override;
+		void draw(std::string_view str, int x, int y) const override;
 
 		/// Draws the given char at row, column
 		void draw(char text, int x, int y) const override;
@@ -47,6 +53,9 @@ namespace panda
 		/// Clears the console from all output
 		void clear() override;
 
+		/// Returns the counters of the last finished frame
+		ConsoleStats stats() const override;
+
 	private:
 		// Helper method, prints the color number for foreground/backround colors
 		void printColors() const;
@@ -63,7 +72,7 @@ namespace panda
 
 		int color(int foreground, int background) const;
 
-		void writeBuffer(const std::string& str) const;
+		void writeBuffer(std::string_view str) const;
 		void writeBuffer(char c) const;
 
 		bool setSize();
@@ -87,5 +96,9 @@ namespace panda
 		int m_fgColor = 0xF;
 		int m_bgColor = 0x0;
 		int m_clearColor = 0x0;
+
+		// Counters of the frame being drawn and the last finished one
+		mutable ConsoleStats m_frameStats;
+		ConsoleStats m_lastFrameStats;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+#include "Game.h"
+#include "Solver.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace panda
+{
+	enum class Difficulty : uint8_t
+	{
+		Easy,
+		Medium,
+		Hard
+	};
+
+	namespace DealRating
+	{
+		/// Cheap properties of a fresh deal that make it harder, read before any move is played
+		struct Features
+		{
+			uint8_t buriedAces = 0;         // cards to remove or draw before each ace is reachable, summed
+			uint8_t closedAboveKings = 0;   // closed cards dealt above each central king, summed
+			uint8_t stockPlayable = 0;      // stock cards reachable in the first pass that play at once
+			uint8_t openingMoves = 0;       // legal card moves of the deal
+		};
+
+		/// Extracts the features of the game, which has to be a fresh deal
+		Features extractFeatures(const Game& game);
+
+		/// Returns the score of the deal, higher is harder
+		/// The solver result and its node count are used when the solver was run, which weighs more than the features
+		uint16_t score(const Features& features, std::optional<Solver::Result> result, size_t nodes);
+
+		/// Ratings of consecutive seeds, stored as one array per field
+		/// The file holds a small header then every column in turn, so a reader can load only the columns it needs
+		struct Table
+		{
+			unsigned int firstSeed = 1;
+			uint8_t drawCount = 1;
+			bool solved = false;    // the solver ran, the result and node columns are meaningful
+
+			std::vector<uint32_t> seeds;
+			std::vector<uint8_t> buriedAces;
+			std::vector<uint8_t> closedAboveKings;
+			std::vector<uint8_t> stockPlayable;
+			std::vector<uint8_t> openingMoves;
+			std::vector<uint8_t> results;    // Solver::Result
+			std::vector<uint32_t> nodes;
+			std::vector<uint16_t> scores;
+			std::vector<Difficulty> difficulties;
+
+			size_t size() const { return seeds.size(); }
+			void resize(size_t size);
+
+			/// Splits the deals into thirds by score, the solver proves no deal lost so every deal is served
+			void classify();
+
+			bool save(const std::filesystem::path& path) const;
+			static std::optional<Table> load(const std::filesystem::path& path);
+		};
+
+		/// Picks a random seed of the difficulty from the rating file, reading only the seed and difficulty columns
+		/// Empty if the file can't be read, was rated for another draw count, or has no deal of the difficulty
+		std::optional<unsigned int> pickSeed(const std::filesystem::path& path, Difficulty difficulty, size_t drawCount, std::mt19937& rng);
+
+		/// The rating file next to the save file in AppData
+		std::filesystem::path defaultPath();
+
+		const char* difficultyName(Difficulty difficulty);
+		std::optional<Difficulty> parseDifficulty(const std::string& name);
+	}
+}
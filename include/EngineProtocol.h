@@ -0,0 +1,77 @@
+#pragma once
+#include "Game.h"
+#include "Move.h"
+#include "Solver.h"
+
+#include <atomic>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace panda
+{
+	/// Line oriented protocol for programs that play the game, in the manner of UCI for chess engines
+	/// Commands are read one per line and drive Game directly, nothing is rendered
+	///
+	/// protocol                                 answers id name Soliterminal, then protocolok
+	/// isready                                  answers readyok once every earlier command is done
+	/// setoption name draw value 1|3            cards opened on each draw, kept by position seed
+	/// setoption name autoplay value true|false moves safe cards to the end stacks after every move, kept by position seed
+	/// position seed N|file PATH|saved [moves M...]
+	/// moves                                    answers moves followed by every legal move
+	/// play M...                                applies the moves, stops at the first illegal one with error illegal move M
+	/// state                                    answers state playing|win|lose hash H
+	/// board                                    answers one line per stack, closed cards in lower case, then boardok
+	/// go [movetime MS] [nodes N]               searches in the background, answers info and bestmove M|none when done
+	/// stop                                     ends the search, its bestmove is written before the next answer
+	/// quit
+	///
+	/// Moves are written d to draw, f9 to flip the top card of stack 9 and 9:3-2 to move the cards of stack 9 from index 3 to stack 2
+	/// Stacks are numbered as in Game::stacks
+	class EngineProtocol
+	{
+	public:
+		/// Starts from the deal of seed 1, with draw three and auto play off
+		explicit EngineProtocol(std::ostream& out);
+		~EngineProtocol();
+
+		/// Deleted copy constructor, the search thread references the protocol
+		EngineProtocol(const EngineProtocol& protocol) = delete;
+
+		/// Executes commands until quit or the end of the input
+		/// The output is flushed whenever no more input is waiting, so a client can send many commands before it reads any answer
+		void run(std::istream& in);
+
+		/// Executes a single command line, returns false for quit
+		bool execute(std::string_view line);
+
+		const Game& game() const { return m_game; }
+
+		/// Returns the protocol text of the move
+		static std::string moveText(const Move& move);
+
+		/// Reads a move in protocol text, flips take their card index from the game. Empty if the text is no move
+		static std::optional<Move> parseMove(std::string_view text, const Game& game);
+
+	private:
+		void position(std::string_view arguments);
+		void setOption(std::string_view arguments);
+		void legalMoves();
+		void play(std::string_view moves);
+		void board();
+		void go(std::string_view arguments);
+		void stopSearch();
+		void search(Game game, Solver::Limits limits);
+
+		std::ostream& m_out;
+		std::mutex m_outMutex;    // the search thread writes its answer while commands are read
+		Game m_game;
+		std::atomic<bool> m_cancel{false};
+		std::thread m_search;
+		std::string m_buffer;    // answer being built, written in one go
+	};
+}
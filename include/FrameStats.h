@@ -0,0 +1,31 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace panda
+{
+	/// Keeps the duration of the most recent frames
+	class FrameStats
+	{
+	public:
+		/// Adds the duration of a finished frame
+		void addFrame(double milliseconds);
+
+		/// Duration of the last frame, zero if there are none
+		double last() const;
+
+		/// Duration below which the given fraction of the recent frames are, zero if there are none
+		double percentile(double fraction) const;
+
+		/// Number of recent frames kept
+		size_t size() const;
+
+	private:
+		static constexpr size_t capacity = 256;
+
+		std::array<double, capacity> m_frames = {};
+		size_t m_next = 0;
+		size_t m_count = 0;
+	};
+}
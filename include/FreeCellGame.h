@@ -0,0 +1,95 @@
+#pragma once
+#include "CardStack.h"
+#include "Move.h"
+
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace panda
+{
+	/// FreeCell with the numbered deals of the classic Windows game
+	/// Stacks 0..3 are the free cells, 4..7 the end stacks and 8..15 the central stacks, every card is open
+	class FreeCellGame
+	{
+	public:
+		enum class State
+		{
+			Playing,
+			Win,
+			Lose
+		};
+
+		/// Stacks in the order of the stack indices
+		explicit FreeCellGame(std::vector<CardStack>&& stacks);
+
+		/// Deals the numbered game, deals 1 to 32000 match the classic set
+		static FreeCellGame createDeal(unsigned int dealNumber);
+
+		const std::vector<CardStack>& stacks() const { return m_stacks; }
+
+		// Returns the game state
+		State state() const { return m_state; }
+
+		/// Returns how many cards can move at once, as if moved one by one through the free cells and empty central stacks
+		size_t maxMovableCards(bool toEmptyStack) const;
+
+		/// Returns if cards can be moved between specified stacks
+		bool canMoveCards(size_t sourceStack, size_t sourceCardIndex, size_t destStack) const;
+
+		/// Moves cards between specified stacks, a run of several cards moves in one go
+		/// Returns false if the cards could not be moved
+		bool moveCards(size_t sourceStack, size_t sourceCardIndex, size_t destStack);
+
+		/// Returns all the moves that can be applied to the current game state
+		std::vector<Move> legalMoves() const;
+
+		/// Applies the move to the game state
+		/// Returns false if the move could not be applied
+		bool applyMove(const Move& move);
+
+		/// Returns a hash of the current game state
+		/// Games that only differ in the order of the free cells or of the central stacks hash the same
+		size_t hash() const;
+
+		/// Enables moving cards to the end stacks automatically after every move
+		/// Only cards that can never be needed again on the central stacks are moved
+		void setAutoPlay(bool enabled);
+		bool autoPlay() const { return m_autoPlay; }
+
+		/// Returns the number of cards of the suit in the end stacks
+		int endHeight(Card::Suit suit) const { return m_endHeights[static_cast<size_t>(suit)]; }
+
+		static constexpr bool isFreeCell(size_t index) { return index < 4; }
+		static constexpr bool isEndStack(size_t index) { return index >= 4 && index < 8; }
+		static constexpr bool isCentralStack(size_t index) { return index >= 8 && index < 16; }
+
+		static constexpr size_t stackCount = 16;
+
+	private:
+		// Returns if the cards from the index to the top are in order with alternating colors
+		bool isRun(const CardStack& stack, size_t firstCardIndex) const;
+
+		// Returns if the card, with the count of cards on top of it, can go on the destination stack
+		bool fits(const Card& card, size_t count, size_t destStack) const;
+
+		// Moves the cards and keeps the counters up to date, the move has to be legal
+		void transfer(size_t sourceStack, size_t sourceCardIndex, size_t destStack);
+
+		// Returns the end stack the card can be moved to, if any
+		std::optional<size_t> endStackFor(const Card& card) const;
+
+		// Moves safe cards to the end stacks until none is left
+		void playSafeCards();
+
+		// Counts the empty stacks and end stack heights from scratch, moves keep them up to date after that
+		void countStacks();
+
+		std::vector<CardStack> m_stacks;
+		State m_state = State::Playing;
+		std::array<int, 4> m_endHeights{};    // cards per suit in the end stacks, indexed by suit
+		size_t m_emptyFreeCells = 0;
+		size_t m_emptyCentralStacks = 0;
+		bool m_autoPlay = false;
+	};
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "FreeCellGame.h"
+#include "Move.h"
+
+#include <atomic>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+namespace panda
+{
+	/// Best first search for a sequence of moves that wins a FreeCell game
+	/// Explores the most promising state first, so solutions are found quickly but are not the shortest
+	/// The search plays with auto-play on, the moves replay on a game with auto-play enabled
+	class FreeCellSolver
+	{
+	public:
+		struct Limits
+		{
+			size_t maxNodes = 200000;
+			std::chrono::milliseconds maxTime{1000};
+			const std::atomic<bool>* cancelled = nullptr;    // optional, stops the search once set
+		};
+
+		enum class Result
+		{
+			Solved,
+			Unsolvable,
+			LimitReached
+		};
+
+		struct Solution
+		{
+			Result result = Result::Unsolvable;
+			std::vector<Move> moves;
+			size_t nodes = 0;
+		};
+
+		FreeCellSolver();
+		explicit FreeCellSolver(Limits limits);
+
+		/// Searches for a winning sequence from the given game state
+		Solution solve(const FreeCellGame& game);
+
+		/// Returns the moves worth exploring from the game state, most promising first
+		/// Moves that only swap symmetric free cells or empty stacks are left out
+		static std::vector<Move> candidateMoves(const FreeCellGame& game);
+
+	private:
+		bool search(const FreeCellGame& game, std::vector<Move>& path);
+		bool limitReached();
+
+		Limits m_limits;
+		std::unordered_set<size_t> m_visited;
+		std::chrono::steady_clock::time_point m_deadline;
+		size_t m_nodes = 0;
+		bool m_limitReached = false;
+	};
+}
@@ -1,13 +1,24 @@
 #pragma once
 #include "CardStack.h"
+#include "Move.h"
+#include "Rules.h"
+#include "Stock.h"
 
 #include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
 
 namespace panda
 {
-	class Game
+	/// Klondike game state and operations, with the rules of the variant given by the Rules policy
+	/// Defined in Game.cpp and instantiated for the policies in Rules.h
+	template <class Rules>
+	class BasicGame
 	{
 	public:
+		using RulesType = Rules;
+
 		struct Stacks
 		{
 			Stacks() = default;
@@ -31,28 +42,76 @@ namespace panda
 			Lose
 		};
 
-		Game(Stacks&& state);
+		/// Stack and card index of a card, as in stacks()
+		struct CardLocation
+		{
+			size_t stack = 0;
+			size_t index = 0;
+		};
+
+		BasicGame(Stacks&& state);
+
+		/// Copies the game with its stacks and stock allocated from the memory resource, kept there on later assignments and resets
+		BasicGame(const BasicGame& other, std::pmr::memory_resource* resource);
+		BasicGame(const BasicGame& other) = default;
+		BasicGame(BasicGame&& other) = default;
+		BasicGame& operator=(const BasicGame& other) = default;
+		BasicGame& operator=(BasicGame&& other) = default;
+
+		static BasicGame createRandomGame();
 
-		static Game createRandomGame();
+		/// Creates a random game from a seed, the same seed always deals the same game
+		static BasicGame createRandomGame(unsigned int seed);
 
-		static Game createNearEndingGame();
+		static BasicGame createNearEndingGame();
 
-		const std::vector<CardStack>& stacks() const { return m_stacks; }
+		/// Returns every stack, the closed and open stacks are rebuilt from the stock when it changed
+		const std::pmr::vector<CardStack>& stacks() const;
+
+		/// Returns a single stack, only rebuilding the closed and open stacks when those are asked for
+		const CardStack& stack(size_t index) const;
+
+		/// Returns the closed and open cards
+		const Stock& stock() const { return m_stock; }
 
 		// Returns the game state
 		State state() const { return m_state; }
 
 		// Game operations on the game state
-		/// Moves a card from closed to open stack
+		/// Opens the next cards of the closed stack, or turns the open stack over when it is empty
 		void openCard();
 
-		/// Moves all the open cards from open to closed stack
+		/// Turns the open cards back into closed cards, in constant time
+		/// Does nothing once the recycle limit of the variant is reached
 		void resetClosedStack();
 
+		/// Returns if there are closed cards to open, or open cards that can be turned over
+		bool canDraw() const;
+
+		/// Number of cards opened on each draw, 1 or 3. Starts as Rules::drawCount, kept on reset
+		void setDrawCount(size_t count) { m_stock.setDrawCount(count); }
+		size_t drawCount() const { return m_stock.drawCount(); }
+
 		/// Moves cards between specified stacks
 		/// Returns false if was not able to move those cards
 		bool moveCards(size_t originStack, size_t cardOriginIndex, size_t destStack);
 
+		/// Returns if cards can be moved between specified stacks
+		bool canMoveCards(size_t originStack, size_t cardOriginIndex, size_t destStack) const;
+
+		/// Returns all the moves that can be applied to the current game state
+		std::vector<Move> legalMoves() const;
+
+		/// Replaces the contents of moves with the legal moves, reusing its capacity
+		void legalMoves(std::vector<Move>& moves) const;
+
+		/// Applies the move to the game state
+		/// Returns false if the move could not be applied
+		bool applyMove(const Move& move);
+
+		/// Returns a hash of the current game state
+		size_t hash() const;
+
 		/// Returns if the card is a flipped card
 		bool isFlippedCard(size_t stack, size_t cardIndex);
 
@@ -61,40 +120,141 @@ namespace panda
 		bool flipCard(size_t stack, size_t cardIndex);
 
 		// Returns true if the index matches an end stack
-		bool isEndStack(size_t index) const;
+		static constexpr bool isEndStack(size_t index) { return index >= 2 && index < 6; }
 
 		// Returns true if the index matches a central stack
-		bool isCentralStack(size_t index) const;
+		static constexpr bool isCentralStack(size_t index) { return index >= 6 && index < 13; }
 
 		// Returns true if the index matches the OpenStack
-		bool isOpenStack(size_t index) const;
+		static constexpr bool isOpenStack(size_t index) { return index == 1; }
 
 		// Returns true if the index matches the ClosedStack
-		bool isClosedStack(size_t index) const;
+		static constexpr bool isClosedStack(size_t index) { return index == 0; }
 
 		// Returns the indices for CentralStacks
-		std::array<size_t, 7> centralStacksIndices() const;
+		static constexpr std::array<size_t, 7> centralStacksIndices() { return {6, 7, 8, 9, 10, 11, 12}; }
 
 		// Returns the indices for EndStacks
-		std::array<size_t, 4> endStacksIndices() const;
+		static constexpr std::array<size_t, 4> endStacksIndices() { return {2, 3, 4, 5}; }
 
 		// Updated the game state if the end stacks are complete
 		void checkWin();
 
-		void reset(Game&& other);
+		/// Sets the game state to Lose when no draw and no productive move is left
+		/// Only looks at the current moves, a full stock cycle without changes is caught when the stock is turned over
+		void checkLose();
+
+		/// Returns if a move makes progress: flips, plays to the end stacks or the stock, takes a card back from the end stacks, or frees a card a waiting card can use
+		/// Shuffling runs between equal parents, kings between empty stacks and cards between end stacks do not count
+		bool hasProductiveMove() const;
+
+		/// Returns true when the closed and open stacks are empty and every central card is open
+		/// From there the game is decided, all cards can go to the end stacks
+		bool canAutoComplete() const;
+
+		/// Moves every remaining card to the end stacks in one go
+		/// Returns the moves that were made, in order
+		std::vector<Move> autoComplete();
+
+		/// Enables moving cards to the end stacks automatically after every move
+		/// Only cards that can never be needed again on the central stacks are moved
+		void setAutoPlay(bool enabled);
+		bool autoPlay() const { return m_autoPlay; }
+
+		/// Returns the number of cards of the suit in the end stacks
+		int endHeight(Card::Suit suit) const { return m_endHeights[static_cast<size_t>(suit)]; }
+
+		/// Returns where the card is, in constant time. Empty if the card is not in the game
+		std::optional<CardLocation> locate(const Card& card) const;
+
+		/// Returns the cards the card can be built on in a central stack, with the rules of the variant
+		static CardSet centralParents(const Card& card);
+
+		/// Returns the card the card goes on in the end stacks, empty for aces
+		static std::optional<Card> endParent(const Card& card);
+
+		/// Returns the open cards of the central stacks as a set, one OR per stack
+		CardSet openCentralCards() const;
+
+		/// Returns the closed cards of the central stacks as a set, closedCentralCards() & numberSet(1) are the buried aces
+		CardSet closedCentralCards() const;
+
+		/// Keeps the auto play and draw count settings of this game
+		void reset(BasicGame&& other);
 
 	private:
-		// Returns the open stack
-		CardStack& openStack();
+		// Moves card to central or end stack, only the top card can move to an end stack
+		bool canMoveToCentralStack(const Card& sourceCard, const CardStack& destStack) const;
+		bool canMoveToEndStack(const Card& sourceCard, bool isTop, const CardStack& destStack) const;
+
+		// Marks the closed and open stacks to be rebuilt from the stock
+		void stockChanged() { m_stockStacksValid = false; }
+
+		// Returns the number of closed cards in the range of the stack
+		size_t closedCards(const CardStack& stack, size_t firstCardIndex) const;
+
+		// Returns true if both opposite color cards one number lower are in the end stacks
+		bool isSafeToEnd(const Card& card) const;
+
+		// Returns the end stack the card can be moved to, if any
+		std::optional<size_t> endStackFor(const Card& card) const;
+
+		// Adds the Cards moves of the card to every stack it fits on, found from the locations of its parents
+		void addCardMoves(std::vector<Move>& moves, size_t sourceStack, size_t cardIndex, const Card& card, bool isTop) const;
+
+		// Returns if the card is the top card of the stack
+		bool isTopCard(const Card& card, size_t stack) const;
+
+		// Records the location of the cards of the stack, from the card index on
+		void placeCards(size_t stack, size_t firstCardIndex);
 
-		// Returns the closed stack
-		CardStack& closedStack();
+		// Records the location of the stock cards in the range of the stock buffer
+		void placeStockCards(size_t first, size_t last);
 
-		// Moves stack to central stack
-		bool canMoveToCentralStack(CardStack& sourceStack, size_t sourceCardIndex, CardStack& destStack);
-		bool canMoveToEndStack(CardStack& sourceStack, size_t sourceCardIndex, CardStack& destStack);
+		// Moves safe open cards to the end stacks until none is left
+		void playSafeCards();
 
-		std::vector<CardStack> m_stacks;
+		// Records that the position changed since the stock was last turned over
+		void positionChanged();
+
+		// Returns if a card that could build on the parent waits in the stock or on a closed card, or empties a column for a waiting king
+		// Follows the end cards that can be taken back onto the parent or a central top in turn, until no new parent turns up
+		bool canUseParent(const Card& parent) const;
+
+		// Returns if a card that can start an empty central stack waits in the stock or on a closed card
+		bool hasWaitingColumnStart() const;
+
+		// Called when the stock is turned over, loses the game when the last cycle left the position as it was
+		void endCycle();
+
+		// Returns if the open stack can still be turned over
+		bool canRecycle() const { return Rules::recycleLimit == unlimitedRecycles || m_recycles < Rules::recycleLimit; }
+
+		// the closed and open entries are only a view of m_stock, rebuilt on demand
+		mutable std::pmr::vector<CardStack> m_stacks;
+		mutable bool m_stockStacksValid = true;
+		Stock m_stock;
 		State m_state = State::Playing;
+		size_t m_closedCentralCards = 0;    // kept up to date on every move and flip
+		std::array<int, 4> m_endHeights{};  // cards per suit in the end stacks, indexed by suit
+		bool m_autoPlay = false;
+		size_t m_recycles = 0;    // only counted for variants with a recycle limit
+
+		// dead position detection, per stock cycle
+		size_t m_cycleHash = 0;          // hash when the stock was last turned over
+		bool m_cycleChanged = true;      // a card moved or flipped during the cycle
+		bool m_stockPlayable = false;    // a drawn card could be played during the cycle
+
+		// location of every card by cardId, updated on every move, draw and recycle
+		struct PackedLocation
+		{
+			uint8_t stack = noStack;
+			uint8_t index = 0;
+		};
+		static constexpr uint8_t noStack = 0xFF;
+		std::array<PackedLocation, cardCount> m_locations{};
 	};
+
+	/// The game as played in the terminal
+	using Game = BasicGame<KlondikeRules>;
 }
\ No newline at end of file
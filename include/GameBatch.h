@@ -0,0 +1,82 @@
+#pragma once
+#include "Game.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace panda
+{
+	/// Klondike games stored as a structure of arrays, so the move legality of many games is computed in lock-step
+	/// Only what the rules look at is kept: the top card of every stack, and the first open card and open count of the central stacks
+	/// Games are grouped in blocks of 32, every (source, dest) pair of a block gets one bit per game
+	class GameBatch
+	{
+	public:
+		/// Implementations of the legality kernel, SSE2 when the compiler targets it, AVX2 when the processor running the program has it
+		enum class Kernel
+		{
+			Scalar,
+			Sse2,
+			Avx2
+		};
+
+		static constexpr size_t blockSize = 32;
+		static constexpr size_t stackCount = 13;
+
+		explicit GameBatch(size_t size);
+
+		size_t size() const { return m_size; }
+
+		/// Copies the stacks of the game into the slot
+		void set(size_t index, const Game& game);
+
+		/// Returns the fastest kernel available on this processor
+		static Kernel bestKernel();
+		static bool isAvailable(Kernel kernel);
+		static const char* kernelName(Kernel kernel);
+
+		/// Computes the legality masks of every game, falls back to the scalar kernel if the kernel is not available
+		void computeMasks(Kernel kernel = bestKernel());
+
+		/// Returns if the top card of the source stack can move to the dest stack, as a Cards move of Game::legalMoves
+		/// Central stacks with a closed top card have nothing to move until it is flipped
+		bool canMoveTop(size_t game, size_t sourceStack, size_t destStack) const;
+
+		/// Returns if the open cards of the central source stack, from the first open one, can move to the dest stack
+		bool canMoveRun(size_t game, size_t sourceStack, size_t destStack) const;
+
+		/// Returns the games of the block whose top card of the source stack can move to the dest stack, one bit per game
+		uint32_t topMask(size_t block, size_t sourceStack, size_t destStack) const { return m_topMasks[(block * stackCount + sourceStack) * stackCount + destStack]; }
+
+		/// Returns the games of the block whose open run of the central source stack can move to the dest stack, one bit per game
+		uint32_t runMask(size_t block, size_t sourceStack, size_t destStack) const { return m_runMasks[(block * 7 + sourceStack - 6) * stackCount + destStack]; }
+
+		/// Lanes of one block, as read by the kernels
+		struct Columns
+		{
+			std::array<const uint8_t*, stackCount> number;     // top card number, zero when empty
+			std::array<const uint8_t*, stackCount> suit;       // top card suit
+			std::array<const uint8_t*, stackCount> red;        // 0xFF when the top card is red
+			std::array<const uint8_t*, stackCount> movable;    // 0xFF when the top card can leave the stack
+			std::array<const uint8_t*, 7> baseNumber;          // first open central card, zero when the top is closed
+			std::array<const uint8_t*, 7> baseRed;
+			std::array<const uint8_t*, 7> openCount;
+		};
+
+	private:
+		Columns columns(size_t block) const;
+
+		size_t m_size = 0;
+		size_t m_blocks = 0;
+		std::array<std::vector<uint8_t>, stackCount> m_number;
+		std::array<std::vector<uint8_t>, stackCount> m_suit;
+		std::array<std::vector<uint8_t>, stackCount> m_red;
+		std::array<std::vector<uint8_t>, stackCount> m_movable;
+		std::array<std::vector<uint8_t>, 7> m_baseNumber;
+		std::array<std::vector<uint8_t>, 7> m_baseRed;
+		std::array<std::vector<uint8_t>, 7> m_openCount;
+		std::vector<uint32_t> m_topMasks;    // per block, source and dest stack
+		std::vector<uint32_t> m_runMasks;    // per block, central source and dest stack
+	};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "GameBatch.h"
+
+#include <cstdint>
+
+// the AVX2 kernel is built in a file of its own, as the only functions there marked for AVX2, and only called when the processor has it
+#if (defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))) || (defined(_MSC_VER) && defined(_M_X64))
+#	define PANDA_BATCH_AVX2
+#endif
+
+namespace panda
+{
+	/// Legality kernels of GameBatch
+	namespace GameBatchKernels
+	{
+		constexpr size_t firstCentral = 6;
+
+		// The same rules on byte lanes, 0xFF is true, so one compare checks a pair of stacks in every game of the vector
+		// computeBlockAvx2 writes it out again with functions marked for AVX2
+		template <class Lanes>
+		void computeBlockSimd(const GameBatch::Columns& c, uint32_t* top, uint32_t* run)
+		{
+			using Vector = typename Lanes::Vector;
+			const Vector zero = Lanes::set1(0);
+			const Vector one = Lanes::set1(1);
+			const Vector king = Lanes::set1(13);
+
+			for (size_t offset = 0; offset < GameBatch::blockSize; offset += Lanes::width)
+			{
+				// plain arrays, std::array drops the alignment attributes of the vector types
+				Vector number[GameBatch::stackCount];
+				Vector sourceNumber[GameBatch::stackCount];    // zero when the top card cannot leave
+				Vector suit[GameBatch::stackCount];
+				Vector red[GameBatch::stackCount];
+				for (size_t stack = 1; stack < GameBatch::stackCount; ++stack)
+				{
+					number[stack] = Lanes::load(c.number[stack] + offset);
+					sourceNumber[stack] = Lanes::bitAnd(number[stack], Lanes::load(c.movable[stack] + offset));
+					suit[stack] = Lanes::load(c.suit[stack] + offset);
+					red[stack] = Lanes::load(c.red[stack] + offset);
+				}
+
+				auto fitsCentral = [&](Vector cardNumber, Vector cardRed, Vector destNumber, Vector destRed, Vector destEmpty) {
+					Vector build = Lanes::bitAnd(Lanes::equal(Lanes::add(cardNumber, one), destNumber), Lanes::bitXor(cardRed, destRed));
+					build = Lanes::andNot(build, Lanes::equal(cardNumber, zero));
+					return Lanes::bitOr(Lanes::bitAnd(destEmpty, Lanes::equal(cardNumber, king)), Lanes::andNot(build, destEmpty));
+				};
+
+				for (size_t dest = 2; dest < GameBatch::stackCount; ++dest)
+				{
+					bool toEnd = Game::isEndStack(dest);
+					Vector destEmpty = Lanes::equal(number[dest], zero);
+					Vector next = Lanes::add(number[dest], one);
+					for (size_t source = 1; source < GameBatch::stackCount; ++source)
+					{
+						if (source == dest)
+							continue;
+
+						Vector legal = toEnd ? Lanes::bitAnd(Lanes::equal(sourceNumber[source], next), Lanes::bitOr(destEmpty, Lanes::equal(suit[source], suit[dest])))
+											 : fitsCentral(sourceNumber[source], red[source], number[dest], red[dest], destEmpty);
+						top[source * GameBatch::stackCount + dest] |= Lanes::mask(legal) << offset;
+
+						if (source < firstCentral)
+							continue;
+						size_t central = source - firstCentral;
+						Vector runLegal;
+						if (toEnd)
+							runLegal = Lanes::bitAnd(legal, Lanes::equal(Lanes::load(c.openCount[central] + offset), one));
+						else
+							runLegal = fitsCentral(Lanes::load(c.baseNumber[central] + offset), Lanes::load(c.baseRed[central] + offset), number[dest], red[dest], destEmpty);
+						run[central * GameBatch::stackCount + dest] |= Lanes::mask(runLegal) << offset;
+					}
+				}
+			}
+		}
+
+		/// Runs the AVX2 kernel on a block, only call it when avx2Compiled() and the processor supports AVX2
+		void computeBlockAvx2(const GameBatch::Columns& c, uint32_t* top, uint32_t* run);
+
+		/// Returns if the compiler built the AVX2 kernel
+		bool avx2Compiled();
+	}
+}
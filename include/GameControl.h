@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Action.h"
+#include "Game.h"
 #include "GameSelection.h"
 
 #include <optional>
@@ -10,17 +11,20 @@ namespace panda
 {
 	class CardStack;
 	class Layout;
-	class Game;
+	class HintEngine;
 
 	class GameControl : public ActionListener
 	{
 	public:
 		
-		GameControl(Game& game, Layout& layout);
+		GameControl(Game& game, Layout& layout, HintEngine& hints);
 		void reset();
 
 		void action(const Action& action);
 
+		// Returns true while a requested hint is still being searched
+		bool hintPending() const;
+
 		size_t stackIndex() const;
 		size_t cardIndex() const;
 
@@ -32,9 +36,15 @@ namespace panda
 		// Returns false if the card could not move
 		bool changeCard(size_t cardIndex);
 		bool isCentralStack();
+		void requestHint();
+		// Picks up a finished hint, and drops it once the game state changes
+		void updateHint();
 
 		Game& m_game;
 		const Layout& m_layout;
+		HintEngine& m_hints;
 		GameSelection m_sel;
+		size_t m_hintHash = 0;
+		bool m_hintRequested = false;
 	};
 }
\ No newline at end of file
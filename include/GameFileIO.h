@@ -10,9 +10,15 @@ namespace panda
 		/// Saves the game to a local file in AppData
 		bool saveGame(const Game& game);
 
+		/// Saves the game to the given file
+		bool saveGame(const Game& game, const std::filesystem::path& path);
+
 		/// Loads the game from the local AppData file
 		std::optional<Game> loadGame();
 
+		/// Loads the game from the given file
+		std::optional<Game> loadGame(const std::filesystem::path& path);
+
 		/// Returns if there is a saved game in AppData
 		bool hasSavedGame();
 
@@ -1,17 +1,20 @@
 #pragma once
 
 #include "Console.h"
+#include "Game.h"
 #include "Render.h"
 
+#include <chrono>
 #include <cmath>
 #include <optional>
+#include <vector>
 namespace panda
 {
-	class Game;
 	class GameSelection;
+	struct Move;
 	class Layout;
 	struct Card;
-	class Stack;
+	class CardStack;
 
 	typedef std::pair<int, int> vec2i;
 
@@ -20,14 +23,22 @@ namespace panda
 	public:
 		GameRender(const Game& game, const GameSelection& selection, const Layout& layout, Console& console);
 
-		// Updates the rendering output
+		// Draws the game into the current console frame
 		void update();
 
+		// Plays back moves made from the given game state, on top of the displayed frame
+		// Only the cells of the moving cards are redrawn, at most one move per frame
+		void playback(const Game& from, const std::vector<Move>& moves);
+
+		// Returns the first console column right of the stacks of the layout
+		int right() const;
+
 	private:
 		int m_cardWidth = 4;           // spaces per card width, for card like 10
 		int m_cardHeight = 3;          // spaces per card height
 		int m_stackSpacing = 4;        // space between stacks
 		int m_cardSpreadHeight = 1;    // spaces per card height for spread cards
+		int m_cardFanWidth = 2;        // spaces per card width for fanned open cards
 
 		int m_openColorFg = 0xF;
 		int m_closedColorFg = 0xF;
@@ -36,6 +47,9 @@ namespace panda
 		int m_selectColor = 0xF;
 		int m_markColor = 0xA;
 		int m_clearColor = 0x0;
+		int m_loseColor = 0xC;
+
+		std::chrono::milliseconds m_playbackFrameTime{16};    // caps playback at 60 frames per second
 
 		// Returns the console position for each layout element
 		std::optional<std::pair<int, int>> indexToConsole(size_t index);
@@ -46,8 +60,17 @@ namespace panda
 		void renderStacks();
 		void renderControlSelect();
 		void renderControlMark();
+		void renderHint(const Move& move);
+		void renderLose();
 
 		std::optional<vec2i> position(size_t stackIndex, size_t cardIndex);
+		std::optional<vec2i> position(const CardStack& stack, size_t stackIndex, size_t cardIndex);
+
+		// Returns the index of the first fanned card of the open stack, as many cards as a draw opens are shown
+		size_t firstFannedCard(const CardStack& openStack) const;
+
+		// Redraws the cells changed by a move from the given state
+		void drawMove(const Game& state, const Move& move);
 
 		void drawCardSpread(const Card& card, vec2i pos);
 		void drawCard(const Card& card, vec2i pos);
@@ -1,5 +1,10 @@
 #pragma once
 
+#include "Move.h"
+
+#include <cstddef>
+#include <optional>
+
 namespace panda
 {
 	class GameSelection
@@ -18,5 +23,6 @@ namespace panda
 		size_t stackIndex = 0;
 		size_t markedCardIndex = 0;
 		size_t markedStackIndex = 0;
+		std::optional<Move> hint;
 	};
 }
\ No newline at end of file
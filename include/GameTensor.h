@@ -0,0 +1,41 @@
+#pragma once
+#include "CardSet.h"
+#include "Game.h"
+
+#include <optional>
+
+namespace panda
+{
+	/// Fixed size numeric view of a position, for learning and analysis
+	/// The tensor is a row of planes, every plane indexed by cardId unless noted
+	namespace GameTensor
+	{
+		constexpr size_t stackCount = 13;
+		constexpr size_t stockCapacity = 24;    // cards dealt to the stock, it never holds more
+
+		/// cardCount x stackCount, 1 at the stack of the card
+		constexpr size_t locationOffset = 0;
+		/// cardCount, 1 when the card is open
+		constexpr size_t openOffset = locationOffset + cardCount * stackCount;
+		/// cardCount, index of the card in its stack
+		constexpr size_t indexOffset = openOffset + cardCount;
+		/// cardCount x stockCapacity, 1 at the position of a stock card in the draw order, open cards first
+		constexpr size_t stockOffset = indexOffset + cardCount;
+		/// 4, cards of every suit on the end stacks, indexed by suit
+		constexpr size_t endOffset = stockOffset + cardCount * stockCapacity;
+		/// 1, cards opened on each draw
+		constexpr size_t drawCountOffset = endOffset + 4;
+		/// Floats per game, a multiple of 16 so games in a batch stay aligned for vector loads
+		constexpr size_t size = (drawCountOffset + 1 + 15) / 16 * 16;
+
+		/// Writes the game into size floats, in one pass over the cards
+		void encode(const Game& game, float* tensor);
+
+		/// Writes count games into count * size floats
+		void encodeBatch(const Game* games, size_t count, float* tensor);
+
+		/// Rebuilds the position and its draw count, auto play is off as in a new game
+		/// Returns empty if the tensor does not hold every card exactly once in consistent stacks
+		std::optional<Game> decode(const float* tensor);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Game.h"
+#include "Move.h"
+#include "Solver.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+namespace panda
+{
+	/// Searches for the best move in a background thread
+	/// Results are cached by game state hash, including every state along a found solution
+	class HintEngine
+	{
+	public:
+		HintEngine();
+		explicit HintEngine(Solver::Limits limits);
+		~HintEngine();
+
+		/// Deleted copy constructor, the worker thread references the engine
+		HintEngine(const HintEngine& engine) = delete;
+
+		/// Returns if the game state was already searched
+		bool searched(const Game& game) const;
+
+		/// Returns the hint for the game state, empty if not searched yet or there is no move to make
+		std::optional<Move> hint(const Game& game) const;
+
+		/// Starts searching the game state in the background, cancelling any running search
+		void request(const Game& game);
+
+		/// Returns true while a search is queued or running
+		bool searching() const;
+
+	private:
+		void run();
+		void store(const Game& game, const Solver::Solution& solution);
+
+		Solver::Limits m_limits;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_requested;
+		std::optional<Game> m_pending;
+		std::unordered_map<size_t, std::optional<Move>> m_cache;    // empty move when there is nothing to play
+		std::atomic<bool> m_cancel{false};
+		bool m_searching = false;
+		bool m_stop = false;
+		std::thread m_thread;    // started last, once everything else is initialised
+	};
+}
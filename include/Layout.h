@@ -2,11 +2,12 @@
 
 #include <array>
 #include <functional>
+#include <memory_resource>
 #include <optional>
+#include <vector>
 
 namespace panda
 {
-	class Game;
 	class CardStack;
 
 	class Graph
@@ -37,6 +38,11 @@ namespace panda
 			std::optional<size_t> right;
 		};
 
+		Graph() = default;
+
+		// Copies the graph with its nodes allocated from the memory resource
+		Graph(const Graph& other, std::pmr::memory_resource* resource);
+
 		// Adds a node to the graph
 		void addNode(Node&& node);
 		// Adds a basic node to the graph, without orientations
@@ -66,8 +72,8 @@ namespace panda
 
 	private:
 		void applyChain(const std::vector<size_t>& chain, std::function<void(Node&, Node&)> relation);
-		std::vector<Node>::iterator Graph::nodeIt(size_t index);
-		std::vector<Node> m_nodes;
+		std::pmr::vector<Node>::iterator nodeIt(size_t index);
+		std::pmr::vector<Node> m_nodes;
 	};
 
 	class Layout
@@ -75,6 +81,9 @@ namespace panda
 	public:
 		Layout(Graph graph);
 
+		// Copies the layout with its graph allocated from the memory resource
+		Layout(const Layout& other, std::pmr::memory_resource* resource);
+
 		// Mapping between the layout and stacks index
 		std::optional<size_t> layoutToIndex(int x, int y) const;
 
@@ -96,4 +105,10 @@ namespace panda
 	private:
 		Graph m_graph;
 	};
+
+	// Creates the layout of the game stacks, as indexed in Game::stacks
+	Layout createGameLayout();
+
+	// Creates the layout of the FreeCell stacks, as indexed in FreeCellGame::stacks
+	Layout createFreeCellLayout();
 }
\ No newline at end of file
@@ -1,39 +1,37 @@
 #pragma once
-#include <algorithm>
 #include <functional>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace panda
 {
-	typedef std::pair<std::string, std::function<void()>> Option;
+	typedef std::pair<std::pmr::string, std::function<void()>> Option;
 
 	/// Menu with text and a series of buttons
+	/// The strings and options are allocated from the memory resource, the actions are expected to be small enough to be stored inline
 	class Menu
 	{
 	public:
-		Menu(std::string title, std::string text, std::vector<Option> options)
-			: m_title(std::move(title))
-			, m_text(std::move(text))
-			, m_options(std::move(options))
+		Menu(std::string_view title,
+			 std::string_view text,
+			 const std::vector<Option>& options,
+			 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_title(title, resource)
+			, m_text(text, resource)
+			, m_options(options.begin(), options.end(), resource)
 		{
 		}
 
-		const std::string& title() const { return m_title; }
-		const std::string& text() const { return m_text; }
-		const std::vector<std::string> optionNames() const
-		{
-			std::vector<std::string> transformed;
-			transformed.resize(m_options.size());
-			std::transform(m_options.begin(), m_options.end(), transformed.begin(), [](const Option& opt) { return opt.first; });
-			return transformed;
-		}
-
-		const std::vector<Option>& options() const { return m_options; }
+		std::string_view title() const { return m_title; }
+		std::string_view text() const { return m_text; }
+		void setText(std::string_view text) { m_text = text; }
+		const std::pmr::vector<Option>& options() const { return m_options; }
 
 	private:
-		std::string m_title;
-		std::string m_text;
-		std::vector<Option> m_options;
+		std::pmr::string m_title;
+		std::pmr::string m_text;
+		std::pmr::vector<Option> m_options;
 	};
-}
\ No newline at end of file
+}
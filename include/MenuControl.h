@@ -12,7 +12,8 @@ namespace panda
 	class MenuControl : public ActionListener
 	{
 	public:
-		MenuControl(const Menu& menu);
+		// The layout of the options is allocated from the memory resource
+		MenuControl(const Menu& menu, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 		void action(const Action& action);
 		const MenuSelection& selection() const;
 	private:
@@ -16,7 +16,7 @@ namespace panda
 	public:
 		MenuRender(const Menu& menu, const MenuSelection& selection, Console& console);
 
-		// Updates the rendering output
+		// Draws the menu into the current console frame
 		void update();
 
 	private:
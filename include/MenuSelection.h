@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace panda
 {
 	class MenuSelection
@@ -9,6 +11,6 @@ namespace panda
 		size_t index() const;
 
 	private:
-		size_t m_index;
+		size_t m_index = 0;
 	};
 }
\ No newline at end of file
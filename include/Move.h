@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+namespace panda
+{
+	/// A single game operation, as applied by Game::applyMove
+	struct Move
+	{
+		enum class Type
+		{
+			Draw,    // open a card from the closed stack, or reset it when empty
+			Flip,    // flip the top card of a stack
+			Cards    // move cards between stacks
+		};
+
+		Type type = Type::Draw;
+		size_t sourceStack = 0;
+		size_t sourceCard = 0;
+		size_t destStack = 0;
+
+		bool operator==(const Move& other) const
+		{
+			return type == other.type && sourceStack == other.sourceStack && sourceCard == other.sourceCard && destStack == other.destStack;
+		}
+		bool operator!=(const Move& other) const { return !(*this == other); }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include "Game.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace panda
+{
+	/// Canonical packed form of a position in 56 bytes, for transposition tables and dedup sets
+	/// Positions that only differ in the order of their central or end stacks pack the same, optionally also positions that differ by a suit swap
+	///
+	/// Bits from the low end of the first word: draw count, open and total stock cards, the end height of every suit, the stock cards in buffer order,
+	/// then per central stack, ordered by the id of its bottom card, its size, its closed cards and its card ids. A card id takes 6 bits
+	/// Auto play, the game state and the per cycle loss tracking are not packed
+	struct PackedGame
+	{
+		static constexpr size_t wordCount = 7;
+
+		std::array<uint64_t, wordCount> words{};
+
+		bool operator==(const PackedGame& other) const { return words == other.words; }
+		bool operator!=(const PackedGame& other) const { return words != other.words; }
+		bool operator<(const PackedGame& other) const { return words < other.words; }
+
+		/// Mixes the words, for hash sets of packed games
+		size_t hash() const;
+
+		struct Hash
+		{
+			size_t operator()(const PackedGame& packed) const { return packed.hash(); }
+		};
+
+		/// Packs the game. With suitSymmetry the smallest packing of the suit swaps that keep the colors apart is taken,
+		/// swapping hearts and diamonds, clubs and spades, or the red and black suits, which changes no move of the game
+		static PackedGame encode(const Game& game, bool suitSymmetry = false);
+
+		/// Rebuilds a game of the position, with the central stacks in packed order and every suit on the end stack of its index
+		/// Returns empty if the words do not hold every card exactly once
+		std::optional<Game> decode() const;
+
+		/// Returns the hash and the equality of the packed games
+		static size_t hash(const Game& game, bool suitSymmetry = false) { return encode(game, suitSymmetry).hash(); }
+		static bool equal(const Game& a, const Game& b, bool suitSymmetry = false) { return encode(a, suitSymmetry) == encode(b, suitSymmetry); }
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Render.h"
+
+namespace panda
+{
+	class Console;
+	class FrameStats;
+
+	/// Draws frame times and console counters on top of the current frame
+	class PerfOverlayRender : public Render
+	{
+	public:
+		// x is the first console column of the overlay, GameRender::right keeps it clear of the stacks
+		PerfOverlayRender(const FrameStats& frameStats, int x, Console& console);
+
+		// Updates the rendering output
+		void update();
+
+	private:
+		int m_x;
+		int m_y = 1;
+		int m_width = 26;
+		int m_textColorFg = 0xE;
+		int m_textColorBg = 0x1;
+
+		const FrameStats& m_frameStats;
+		Console& m_console;
+	};
+}
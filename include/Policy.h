@@ -0,0 +1,72 @@
+#pragma once
+#include "Game.h"
+#include "Move.h"
+#include "Solver.h"
+
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+
+namespace panda
+{
+	/// Strategy that picks the next move to play in a game
+	class Policy
+	{
+	public:
+		virtual ~Policy() = default;
+
+		/// Name used to select the policy and report its results
+		virtual std::string name() const = 0;
+
+		/// Prepares the policy to play a new game
+		virtual void reset() {}
+
+		/// Returns the next move to play, or empty if the policy gives up
+		virtual std::optional<Move> choose(const Game& game, std::mt19937& rng) = 0;
+	};
+
+	/// Plays any legal move, uniformly at random
+	class RandomPolicy : public Policy
+	{
+	public:
+		std::string name() const override { return "random"; }
+		std::optional<Move> choose(const Game& game, std::mt19937& rng) override;
+	};
+
+	/// Prefers flips and end stack moves, then moves that expose closed cards, then drawing
+	/// Gives up after a full pass over the closed stack without any other move
+	class GreedyPolicy : public Policy
+	{
+	public:
+		std::string name() const override { return "greedy"; }
+		void reset() override;
+		std::optional<Move> choose(const Game& game, std::mt19937& rng) override;
+
+	private:
+		size_t m_drawsWithoutProgress = 0;
+	};
+
+	/// Plays the solution found by the solver, falls back to greedy if there is none
+	class SolverPolicy : public Policy
+	{
+	public:
+		SolverPolicy() = default;
+		explicit SolverPolicy(Solver::Limits limits);
+
+		std::string name() const override { return "solver"; }
+		void reset() override;
+		std::optional<Move> choose(const Game& game, std::mt19937& rng) override;
+
+	private:
+		Solver m_solver;
+		GreedyPolicy m_fallback;
+		std::vector<Move> m_plan;
+		size_t m_planIndex = 0;
+		bool m_searched = false;
+	};
+
+	/// Creates a policy by name: random, greedy or solver
+	/// Returns nullptr for unknown names
+	std::unique_ptr<Policy> createPolicy(const std::string& name);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Scoped timers and counters, written out as a Chrome trace (chrome://tracing, ui.perfetto.dev)
+// Only compiled in when SOLITERMINAL_PROFILING is defined, otherwise the macros expand to nothing
+
+#ifdef SOLITERMINAL_PROFILING
+
+#	include <chrono>
+#	include <cstdint>
+#	include <filesystem>
+
+namespace panda
+{
+	namespace Profiler
+	{
+		/// Nanoseconds on the steady clock
+		inline int64_t now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		/// Records a finished scope, name has to be a string literal
+		void recordScope(const char* name, int64_t start, int64_t end);
+
+		/// Records the value of a counter, name has to be a string literal
+		void recordCounter(const char* name, int64_t value);
+
+		/// Writes all recorded events as Chrome trace event JSON
+		/// Returns false if the file could not be written
+		bool writeTrace(const std::filesystem::path& path);
+
+		/// Drops all recorded events
+		void clear();
+
+		/// Records the time between construction and destruction
+		class ScopedTimer
+		{
+		public:
+			explicit ScopedTimer(const char* name)
+				: m_name(name)
+				, m_start(now())
+			{
+			}
+			~ScopedTimer() { recordScope(m_name, m_start, now()); }
+
+			ScopedTimer(const ScopedTimer& timer) = delete;
+
+		private:
+			const char* m_name;
+			int64_t m_start;
+		};
+	}
+}
+
+#	define PANDA_PROFILE_CONCAT_IMPL(a, b) a##b
+#	define PANDA_PROFILE_CONCAT(a, b) PANDA_PROFILE_CONCAT_IMPL(a, b)
+#	define PANDA_PROFILE_SCOPE(name) ::panda::Profiler::ScopedTimer PANDA_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#	define PANDA_PROFILE_COUNTER(name, value) ::panda::Profiler::recordCounter(name, static_cast<int64_t>(value))
+
+#else
+
+#	define PANDA_PROFILE_SCOPE(name)
+#	define PANDA_PROFILE_COUNTER(name, value)
+
+#endif
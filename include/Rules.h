@@ -0,0 +1,52 @@
+#pragma once
+#include "Card.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace panda
+{
+	// Rules policies for BasicGame
+	// Every setting is a compile time constant or an inline check, so each variant compiles into its own engine
+	// with no branching on settings at run time
+
+	/// Recycle limit of variants that can turn the open stack over any number of times
+	constexpr size_t unlimitedRecycles = std::numeric_limits<size_t>::max();
+
+	/// Hearts and diamonds are red, inline so rules checks never leave the engine
+	inline bool isRed(const Card& card) { return card.suit == Card::Suit::Heart || card.suit == Card::Suit::Diamond; }
+
+	/// Klondike: kings start empty central stacks, build down in alternating colors
+	struct KlondikeRules
+	{
+		static constexpr size_t drawCount = 1;                       // cards opened on each draw, when a game starts
+		static constexpr size_t recycleLimit = unlimitedRecycles;    // times the open stack can be turned over
+
+		/// Returns if the card can be moved to an empty central stack
+		static bool canStartColumn(const Card& card) { return card.number == 13; }
+
+		/// Returns if the card can be moved on top of a central stack card
+		static bool canBuildOn(const Card& card, const Card& top) { return card.number + 1 == top.number && isRed(card) != isRed(top); }
+	};
+
+	/// Klondike opening three cards on each draw
+	struct KlondikeDrawThreeRules : KlondikeRules
+	{
+		static constexpr size_t drawCount = 3;
+	};
+
+	/// Vegas: draw three, the open stack can be turned over twice
+	struct VegasRules : KlondikeDrawThreeRules
+	{
+		static constexpr size_t recycleLimit = 2;
+	};
+
+	/// Thumb and Pouch: any card starts an empty central stack, build down in any other suit, a single pass through the stock
+	struct ThumbAndPouchRules : KlondikeRules
+	{
+		static constexpr size_t recycleLimit = 0;
+
+		static bool canStartColumn(const Card&) { return true; }
+		static bool canBuildOn(const Card& card, const Card& top) { return card.number + 1 == top.number && card.suit != top.suit; }
+	};
+}
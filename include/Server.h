@@ -0,0 +1,136 @@
+#pragma once
+#include "HintEngine.h"
+#include "Session.h"
+#include "TelnetInput.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace panda
+{
+	/// Hosts many game sessions in one thread, on an epoll event loop over loopback TCP and Unix sockets
+	/// Each connection gets a Session, frames are sent as ANSI diffs so idle sessions cost no traffic
+	/// Spectators connect to a port of their own and watch a session. Each frame is encoded once into a shared buffer and written to every viewer
+	class Server
+	{
+	public:
+		struct Stats
+		{
+			size_t sessions = 0;
+			size_t peakSessions = 0;
+			size_t activeSessions = 0;    // sessions with a game still in play, summed before every report
+			size_t accepted = 0;
+			size_t bytesReceived = 0;
+			size_t bytesSent = 0;
+			size_t arenaBytes = 0;       // session arenas in use, summed before every report
+			size_t overflowBytes = 0;    // session memory that did not fit in the arenas
+			size_t viewers = 0;
+			size_t peakViewers = 0;
+			size_t framesBroadcast = 0;    // frames of watched sessions, each encoded once for all of their viewers
+			size_t bytesBroadcast = 0;     // bytes written to viewers
+			size_t viewerSkips = 0;        // times a viewer that fell behind skipped to the latest keyframe
+		};
+
+		struct Config
+		{
+			uint16_t port = 2323;    // loopback TCP port, zero for none
+			std::string unixPath;    // Unix socket path, empty for none
+			int width = 80;
+			int height = 40;
+			size_t maxSessions = 10000;
+			size_t maxPendingBytes = 1 << 20;    // output a client may fall behind by before it is dropped
+			uint16_t watchPort = 0;              // loopback TCP port for spectators, zero for none
+			size_t maxViewers = 10000;
+			size_t maxViewerBytes = 64 * 1024;    // frames a viewer may fall behind by before it skips to the latest keyframe
+			std::chrono::milliseconds reportInterval{0};    // how often report is called from the loop, zero for never
+			std::function<void(const Stats&)> report;
+		};
+
+		/// Opens the listening sockets, throws std::runtime_error if one can't be opened
+		explicit Server(Config config);
+		~Server();
+
+		/// Deleted copy constructor, the server owns its sockets
+		Server(const Server& server) = delete;
+
+		/// Runs the event loop until stop is called
+		void run();
+
+		/// Stops the event loop, can be called from a signal handler or another thread
+		void stop();
+
+		const Stats& stats() const { return m_stats; }
+
+	private:
+		// immutable once encoded, shared by every viewer it is queued for
+		using Frame = std::shared_ptr<const std::string>;
+
+		struct Connection
+		{
+			int fd = -1;
+			uint32_t id = 0;    // number spectators pick the session by
+			std::unique_ptr<Session> session;
+			bool writeWatched = false;    // waiting for the socket to take more output
+			std::vector<int> viewers;
+			Frame keyframe;    // encoded on demand, until the next frame
+		};
+
+		struct Viewer
+		{
+			int fd = -1;
+			int player = -1;    // connection watched, none while the game is being picked
+			std::string choice;    // digits typed at the prompt
+			TelnetInput input;
+			std::deque<Frame> frames;
+			size_t offset = 0;     // bytes of the first frame already sent
+			size_t pending = 0;    // bytes of the frames not yet sent
+			bool writeWatched = false;
+		};
+
+		int listenTcp(uint16_t port);
+		void listenUnix();
+		void watch(int fd, uint32_t events);
+		void accept(int listenFd);
+		void acceptViewer(int listenFd);
+		void read(Connection& connection);
+		void flush(Connection& connection);
+		void close(int fd);
+
+		// Sends the frames drawn since the output had the given size to the viewers of the connection
+		void broadcast(Connection& connection, size_t outputStart);
+		Frame keyframe(Connection& connection);
+		void queue(Viewer& viewer, Frame frame);
+		void prompt(Viewer& viewer, const std::string& message);
+		void readViewer(Viewer& viewer);
+		void attach(Viewer& viewer);
+		void flushViewer(Viewer& viewer);
+		void closeViewer(int fd);
+		void updateHints();
+		void updateSessionStats();
+		int timeout() const;
+
+		Config m_config;
+		HintEngine m_hints;
+		int m_epoll = -1;
+		int m_wake = -1;    // eventfd written by stop
+		std::vector<int> m_listeners;
+		int m_watchListener = -1;
+		std::unordered_map<int, Connection> m_connections;
+		std::map<uint32_t, int> m_sessionIds;    // connection of every session id, oldest first
+		std::unordered_map<int, Viewer> m_viewers;
+		uint32_t m_nextId = 1;
+		std::vector<int> m_hintWaiters;    // connections with a hint being searched
+		std::atomic<bool> m_stop{false};
+		unsigned int m_nextSeed = 1;
+		std::chrono::steady_clock::time_point m_nextReport;
+		Stats m_stats;
+	};
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "Action.h"
+#include "App.h"
+#include "AppControl.h"
+#include "AppRender.h"
+#include "Arena.h"
+#include "ConsoleAnsi.h"
+#include "FrameStats.h"
+#include "Game.h"
+#include "GameControl.h"
+#include "GameRender.h"
+#include "Layout.h"
+#include "Menu.h"
+#include "MenuControl.h"
+#include "MenuRender.h"
+#include "PerfOverlayRender.h"
+#include "TelnetInput.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace panda
+{
+	class HintEngine;
+
+	/// One player of the game server: the game, its controls and renders, drawing ANSI frames for a remote terminal
+	/// Input arrives as the raw bytes of a telnet connection, output is read from the console and sent back by the server
+	/// The game, layouts, menu and console grids are allocated from an arena inside the session, so a session is a single block
+	class Session
+	{
+	public:
+		/// Hints are shared with the other sessions, a single search runs at a time
+		Session(HintEngine& hints, unsigned int seed, int width = 80, int height = 40);
+
+		/// Deleted copy constructor, controls and renders reference the members
+		Session(const Session& session) = delete;
+
+		/// Bytes the terminal should send first, to switch a telnet client to character mode without local echo
+		static const std::string& greeting();
+
+		/// Handles the bytes read from the connection, and draws a frame if anything changed
+		void receive(const char* data, size_t size);
+
+		/// Draws a new frame if a requested hint was found, returns true while one is still searched
+		bool updateHint();
+
+		/// Returns true while a requested hint is searched
+		bool hintPending() const { return m_gameControl.hintPending(); }
+
+		/// Frames waiting to be sent, drop the sent bytes with consume
+		const std::pmr::string& output() const { return m_console.output(); }
+		void consume(size_t bytes) { m_console.consume(bytes); }
+
+		/// The whole screen as the terminal shows it once the output is sent, the frames that follow apply on top of it
+		std::string keyframe() const { return m_console.keyframe(); }
+
+		/// Returns true once the player left, the connection closes after the output is sent
+		bool closed() const { return m_app.state() == App::State::Exit; }
+
+		/// Returns true while the game can still be won, won and lost games leave the session idle
+		bool playing() const { return m_game.state() == Game::State::Playing; }
+
+		/// Bytes of the arena in use, and bytes allocated outside of it once it is full
+		size_t arenaBytes() const { return m_arena.used(); }
+		size_t overflowBytes() const { return m_arena.overflow(); }
+
+		/// Size of the arena, a session on the default 80x40 terminal uses about 24 KB of it, larger ones spill over to the heap
+		static constexpr size_t arenaCapacity = 28 * 1024;
+
+	private:
+		void action(Action action);
+
+		// declared first, the members below are allocated from it and have to go before it
+		alignas(std::max_align_t) std::array<std::byte, arenaCapacity> m_arenaBuffer;
+		Arena m_arena;
+
+		Game m_game;
+		App m_app;
+		Layout m_layout;
+		GameControl m_gameControl;
+		Menu m_menu;
+		MenuControl m_menuControl;
+		ConsoleAnsi m_console;
+		FrameStats m_frameStats;
+		GameRender m_gameRender;
+		MenuRender m_menuRender;
+		PerfOverlayRender m_overlayRender;
+		AppControl m_appControl;
+		AppRender m_appRender;
+		TelnetInput m_input;
+	};
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Policy.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace panda
+{
+	namespace Simulation
+	{
+		struct GameResult
+		{
+			unsigned int seed = 0;
+			bool won = false;
+			size_t moves = 0;
+			double microseconds = 0.0;
+		};
+
+		struct Config
+		{
+			std::string policy = "greedy";
+			unsigned int firstSeed = 1;
+			size_t games = 1000;
+			size_t threads = 0;    // zero uses the hardware concurrency
+			size_t maxMoves = 1000;
+			bool autoPlay = false;    // move safe cards to the end stacks after every move
+			size_t drawCount = 1;     // cards opened on each draw, 1 or 3
+		};
+
+		struct Report
+		{
+			std::string policy;
+			size_t threads = 0;
+			double wallSeconds = 0.0;
+			std::vector<GameResult> results;
+
+			size_t wins() const;
+			double winRate() const;
+			double averageMoves() const;
+			double averageMicroseconds() const;
+			double gamesPerSecond() const;
+			double totalSeconds() const;    // time spent in all games, summed over the threads
+		};
+
+		/// Plays the game on with the policy until it is won, the policy gives up or maxMoves are played, returns the moves played
+		size_t playOut(Game& game, Policy& policy, std::mt19937& rng, size_t maxMoves);
+
+		/// Plays the seeded deal with the rules of the config until it is won, the policy gives up or maxMoves are played
+		GameResult playGame(unsigned int seed, Policy& policy, const Config& config);
+
+		/// Plays config.games consecutive seeds, sharded across a thread pool
+		/// Results are ordered by seed and do not depend on the number of threads
+		/// Throws std::invalid_argument if the policy is unknown
+		Report run(const Config& config);
+
+		/// Solves config.games consecutive numbered FreeCell deals from config.firstSeed, sharded across a thread pool
+		/// A result is won when the deal was solved, moves is the length of the solution
+		Report solveFreeCell(const Config& config);
+	}
+}
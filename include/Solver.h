@@ -0,0 +1,60 @@
+#pragma once
+#include "Game.h"
+#include "Move.h"
+
+#include <atomic>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+namespace panda
+{
+	/// Depth first search for a sequence of moves that wins the game
+	/// The search is pruned, it never takes cards back from the end stacks, only splits runs to free a card for the end stacks
+	/// and skips states by their hash, so running out of moves does not prove the game lost
+	class Solver
+	{
+	public:
+		struct Limits
+		{
+			size_t maxNodes = 200000;
+			std::chrono::milliseconds maxTime{1000};
+			const std::atomic<bool>* cancelled = nullptr;    // optional, stops the search once set
+		};
+
+		enum class Result
+		{
+			Solved,
+			Unsolvable,    // for a complete search without a win, the pruned search never reports it
+			LimitReached,
+			NotFound    // every candidate move was explored without a win, kept last as rating files store the values
+		};
+
+		struct Solution
+		{
+			Result result = Result::NotFound;
+			std::vector<Move> moves;
+			size_t nodes = 0;
+		};
+
+		Solver();
+		explicit Solver(Limits limits);
+
+		/// Searches for a winning sequence from the given game state
+		Solution solve(const Game& game);
+
+		/// Returns the moves worth exploring from the game state, most promising first
+		/// Pointless moves, like shuffling open cards between central stacks, are left out
+		static std::vector<Move> candidateMoves(const Game& game);
+
+	private:
+		bool search(const Game& game, std::vector<Move>& path);
+		bool limitReached();
+
+		Limits m_limits;
+		std::unordered_set<size_t> m_visited;
+		std::chrono::steady_clock::time_point m_deadline;
+		size_t m_nodes = 0;
+		bool m_limitReached = false;
+	};
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "CardStack.h"
+#include "Move.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace panda
+{
+	/// Spider solitaire with two decks, 104 cards on ten central stacks
+	/// Stack 0 is the closed stack, dealt a row at a time, stacks 1..8 hold the completed runs and 9..18 are the central stacks
+	class SpiderGame
+	{
+	public:
+		enum class State
+		{
+			Playing,
+			Win,
+			Lose
+		};
+
+		/// Stacks in the order of the stack indices, central stacks with their top card open
+		explicit SpiderGame(std::vector<CardStack>&& stacks);
+
+		/// Creates a random game from a seed with 1, 2 or 4 suits, the same seed always deals the same game
+		static SpiderGame createRandomGame(unsigned int seed, size_t suits = 4);
+
+		const std::vector<CardStack>& stacks() const { return m_stacks; }
+
+		// Returns the game state
+		State state() const { return m_state; }
+
+		/// Returns if a row can be dealt, there have to be closed cards and no empty central stack
+		bool canDeal() const;
+
+		/// Deals one open card on every central stack
+		/// Returns false if no row could be dealt
+		bool deal();
+
+		/// Returns if the cards from the index to the top form a run that fits on the destination
+		bool canMoveCards(size_t sourceStack, size_t sourceCardIndex, size_t destStack) const;
+
+		/// Moves a run between central stacks, removes a completed run and opens the card left on top
+		/// Returns false if the cards could not be moved
+		bool moveCards(size_t sourceStack, size_t sourceCardIndex, size_t destStack);
+
+		/// Returns all the moves that can be applied, a Draw move deals a row
+		std::vector<Move> legalMoves() const;
+
+		/// Applies the move to the game state
+		/// Returns false if the move could not be applied
+		bool applyMove(const Move& move);
+
+		/// Returns a hash of the current game state
+		size_t hash() const;
+
+		/// Returns the number of same suit cards in order on top of the central stack, in constant time
+		size_t runLength(size_t stack) const;
+
+		/// Returns the number of runs from king to ace removed so far
+		size_t completedRuns() const { return m_completedRuns; }
+
+		static constexpr bool isClosedStack(size_t index) { return index == 0; }
+		static constexpr bool isEndStack(size_t index) { return index >= 1 && index < 9; }
+		static constexpr bool isCentralStack(size_t index) { return index >= 9 && index < 19; }
+
+		static constexpr size_t stackCount = 19;
+		static constexpr std::array<size_t, 10> centralStacksIndices() { return {9, 10, 11, 12, 13, 14, 15, 16, 17, 18}; }
+
+	private:
+		// Sets the run length of the cards from the index to the top, from the run length of the card below
+		void updateRuns(size_t stack, size_t firstCardIndex);
+
+		// Moves a completed run to the end stacks and opens the new top card
+		void settle(size_t stack);
+
+		std::vector<CardStack> m_stacks;
+		std::array<std::vector<uint8_t>, 10> m_runs;    // per central card, length of the same suit run ending at it
+		size_t m_completedRuns = 0;
+		State m_state = State::Playing;
+	};
+}
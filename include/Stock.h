@@ -0,0 +1,62 @@
+#pragma once
+#include "Card.h"
+
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace panda
+{
+	class CardStack;
+
+	/// Closed and open stack sharing one buffer, split by an index
+	/// Cards before the split are open, with the top card last. Cards from the split on are closed, in the order they are drawn
+	/// Drawing moves the split forward and turning the stack over moves it back to zero, no cards are moved or flipped
+	class Stock
+	{
+	public:
+		/// Cards in the order they are drawn, all closed
+		explicit Stock(std::pmr::vector<Card>&& cards = {});
+
+		/// Builds the buffer from a closed stack, drawn from the top, and an open stack
+		Stock(const CardStack& closedStack, const CardStack& openStack);
+
+		/// Number of cards opened on each draw, 1 or 3
+		void setDrawCount(size_t count);
+		size_t drawCount() const { return m_drawCount; }
+
+		/// Opens the next cards of the closed stack
+		/// Returns false if there are no closed cards
+		bool draw();
+
+		/// Turns the open cards back into closed cards, to be drawn in the same order again
+		/// Returns false if there are closed cards left, or no open cards
+		bool recycle();
+
+		/// Returns the top open card
+		std::optional<Card> top() const;
+
+		/// Removes the top open card and returns it
+		std::optional<Card> takeTop();
+
+		size_t closedSize() const { return m_cards.size() - m_split; }
+		size_t openSize() const { return m_split; }
+		size_t size() const { return m_cards.size(); }
+
+		/// Number of cards from the front of the buffer that were open at some point, the rest of the closed cards were never seen
+		/// A stock built from stacks only counts its open cards as seen
+		size_t seenSize() const { return m_seen; }
+
+		/// Returns the buffer, open cards first. Card states in the buffer are not kept up to date
+		const std::pmr::vector<Card>& cards() const { return m_cards; }
+
+		/// Writes the cards as a closed and an open stack, with their card states
+		void toStacks(CardStack& closedStack, CardStack& openStack) const;
+
+	private:
+		std::pmr::vector<Card> m_cards;
+		size_t m_split = 0;    // number of open cards
+		size_t m_seen = 0;     // never below the split, draws only ever open the cards right after it
+		size_t m_drawCount = 1;
+	};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace panda
+{
+	/// Splits the bytes of a telnet connection into keys, dropping the telnet commands and reading escape sequences as one key
+	/// Commands and sequences can be split over reads, the parser keeps its state between them
+	class TelnetInput
+	{
+	public:
+		struct Key
+		{
+			enum class Type : uint8_t
+			{
+				Char,
+				Escape,      // a lone escape
+				Sequence     // ESC [ or ESC O sequence, with its final byte as the character
+			};
+
+			Type type;
+			char c;
+		};
+
+		/// Returns the next key of the bytes from position on and moves position past it, empty once every byte is used
+		std::optional<Key> next(const char* data, size_t size, size_t& position);
+
+		/// Returns the escape left at the end of a read, terminals send sequences in one piece
+		std::optional<Key> finish();
+
+	private:
+		enum class State : uint8_t
+		{
+			Text,
+			Command,       // after IAC
+			Option,        // after IAC WILL, WONT, DO or DONT
+			Subnegotiation,
+			SubnegotiationCommand,
+			Escape,        // after ESC
+			Sequence       // after ESC [ or ESC O
+		};
+
+		State m_state = State::Text;
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace panda
+{
+	/// Fixed size pool of worker threads consuming a shared task queue
+	class ThreadPool
+	{
+	public:
+		/// Creates the pool, zero threads uses the hardware concurrency
+		explicit ThreadPool(size_t threads = 0);
+		~ThreadPool();
+
+		/// Deleted copy constructor, workers reference the pool
+		ThreadPool(const ThreadPool& pool) = delete;
+
+		/// Queues a task to be run by any worker
+		void submit(std::function<void()> task);
+
+		/// Blocks until every submitted task has finished
+		void wait();
+
+		/// Number of worker threads
+		size_t size() const;
+
+	private:
+		void run();
+
+		std::vector<std::thread> m_threads;
+		std::queue<std::function<void()>> m_tasks;
+		std::mutex m_mutex;
+		std::condition_variable m_taskReady;
+		std::condition_variable m_tasksDone;
+		size_t m_pending = 0;    // queued and running tasks
+		bool m_stop = false;
+	};
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "Action.h"
 
+#include <chrono>
 #include <conio.h>
 
 namespace panda
@@ -9,5 +10,8 @@ namespace panda
 	{
 	public:
 		static Action waitForInput();
+
+		// Waits at most timeout for input, returns Action::None if there was none
+		static Action waitForInput(std::chrono::milliseconds timeout);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+#include "CardSet.h"
+#include "Game.h"
+#include "Move.h"
+#include "ThreadPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace panda
+{
+	/// Many Klondike games stepped together for reinforcement learning, sharded over a thread pool
+	/// Observations, legal action masks, rewards and done flags are written to buffers owned by the caller, the envs allocate nothing per step
+	///
+	/// Action 0 draws, action 1 + source * stackCount + dest moves the cards of the source stack that fit on the dest stack
+	/// When source and dest are the same central stack, the action flips its top card
+	class VecEnv
+	{
+	public:
+		static constexpr size_t stackCount = 13;
+		static constexpr size_t actionCount = 1 + stackCount * stackCount;
+
+		/// Per card, in cardId order: stack, index in the stack and 1 when the card is open
+		static constexpr size_t observationSize = cardCount * 3;
+
+		struct Config
+		{
+			size_t envs = 256;
+			unsigned int firstSeed = 1;    // env i first deals seed firstSeed + i, then every envs seeds further
+			size_t threads = 0;            // zero uses the hardware concurrency
+			size_t drawCount = 1;
+			bool autoPlay = false;
+			size_t maxSteps = 1000;    // episodes are cut off after this many steps
+		};
+
+		/// Caller owned buffers, with room for every env
+		struct Buffers
+		{
+			uint8_t* observations = nullptr;    // envs * observationSize
+			uint8_t* masks = nullptr;           // envs * actionCount, 1 for the legal actions
+			float* rewards = nullptr;           // envs, change of the cards on the end stacks
+			uint8_t* dones = nullptr;           // envs, 1 when the step ended the episode, the observation is then the next deal
+		};
+
+		struct Stats
+		{
+			size_t steps = 0;
+			size_t episodes = 0;    // finished episodes
+			size_t wins = 0;
+			size_t illegalActions = 0;    // actions that were not legal, the game was left as it was
+		};
+
+		explicit VecEnv(Config config);
+
+		size_t size() const { return m_envs.size(); }
+
+		/// Deals every env its next game and writes the first observations and masks, rewards and dones are zeroed
+		/// seeds gives one seed per env, empty keeps the seeds of the config
+		void reset(const Buffers& out, const unsigned int* seeds = nullptr);
+
+		/// Applies one action per env, an env whose episode ends deals its next game at once
+		void step(const uint32_t* actions, const Buffers& out);
+
+		/// Returns the action of the move
+		static uint32_t actionOf(const Move& move);
+
+		const Game& game(size_t env) const { return m_envs[env].game; }
+
+		/// Sums the counters of every env
+		Stats stats() const;
+
+	private:
+		struct Env
+		{
+			explicit Env(Game&& game)
+				: game(std::move(game))
+			{
+			}
+
+			Game game;
+			std::vector<Move> moves;    // legal moves of the game, capacity kept between steps
+			unsigned int seed = 0;
+			size_t steps = 0;    // of the episode
+			int endCards = 0;
+			Stats stats;
+		};
+
+		// Runs the function over every env, in one shard per thread
+		template <class Function>
+		void forEachShard(Function function);
+
+		void deal(Env& env, unsigned int seed);
+		void stepEnv(size_t index, uint32_t action, const Buffers& out);
+		void write(size_t index, const Buffers& out);
+
+		Config m_config;
+		std::vector<Env> m_envs;
+		std::unique_ptr<ThreadPool> m_pool;    // none for a single thread, the shard runs on the caller
+	};
+}
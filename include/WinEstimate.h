@@ -0,0 +1,53 @@
+#pragma once
+#include "Game.h"
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <utility>
+
+namespace panda
+{
+	class ThreadPool;
+
+	/// Monte Carlo estimate of the chance to win from a position
+	/// The closed cards are what the player has not seen: every sample deals them anew over the closed places, and a policy plays the sample out
+	namespace WinEstimate
+	{
+		struct Config
+		{
+			std::string policy = "greedy";    // random, greedy or solver, see createPolicy
+			std::chrono::milliseconds budget{200};
+			size_t maxSamples = 100000;
+			size_t threads = 0;    // zero uses the hardware concurrency
+			size_t maxMoves = 1000;
+			unsigned int seed = 1;    // samples of the same position and sample count are the same for the same seed
+			const std::atomic<bool>* cancelled = nullptr;    // optional, stops sampling once set
+		};
+
+		struct Estimate
+		{
+			size_t samples = 0;
+			size_t wins = 0;
+			double probability = 0.0;
+			double low = 0.0;     // 95% Wilson score interval
+			double high = 1.0;
+			double seconds = 0.0;
+		};
+
+		/// Plays samples of the position on all threads until the budget or maxSamples is used up
+		/// Throws std::invalid_argument if the policy is unknown
+		Estimate estimate(const Game& game, const Config& config);
+
+		/// Same on the threads of the pool, the threads of the config are ignored
+		Estimate estimate(const Game& game, const Config& config, ThreadPool& pool);
+
+		/// Returns the position with its unseen cards dealt anew, the closed central cards and the stock cards never opened
+		/// Open cards, every card state and the stock cards seen before the stock was turned over are kept. Safe to call on one game from many threads
+		Game sample(const Game& game, std::mt19937& rng);
+
+		/// Returns the 95% Wilson score interval of wins out of samples
+		std::pair<double, double> interval(size_t wins, size_t samples);
+	}
+}
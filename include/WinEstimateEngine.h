@@ -0,0 +1,50 @@
+#pragma once
+#include "Game.h"
+#include "ThreadPool.h"
+#include "WinEstimate.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace panda
+{
+	/// Estimates the chance to win in a background thread, on a pool of threads kept for every estimate
+	/// Only the estimate of the last requested game state is kept
+	class WinEstimateEngine
+	{
+	public:
+		explicit WinEstimateEngine(WinEstimate::Config config);
+		~WinEstimateEngine();
+
+		/// Deleted copy constructor, the worker thread references the engine
+		WinEstimateEngine(const WinEstimateEngine& engine) = delete;
+
+		/// Returns the estimate of the game state, empty if it is not finished yet
+		std::optional<WinEstimate::Estimate> estimate(const Game& game) const;
+
+		/// Starts estimating the game state in the background, cancelling any other running estimate
+		/// Does nothing if the state is already estimated or being estimated
+		void request(const Game& game);
+
+		/// Returns true while an estimate is queued or running
+		bool estimating() const;
+
+	private:
+		void run();
+
+		WinEstimate::Config m_config;
+		ThreadPool m_pool;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_requested;
+		std::optional<Game> m_pending;
+		size_t m_hash = 0;    // state of the last request, the estimate belongs to it once set
+		std::optional<WinEstimate::Estimate> m_estimate;
+		std::atomic<bool> m_cancel{false};
+		bool m_estimating = false;
+		bool m_stop = false;
+		std::thread m_thread;    // started last, once everything else is initialised
+	};
+}
@@ -19,4 +19,8 @@ namespace panda
 	void App::setState(State state) { m_state = state; }
 
 	App::State App::state() const { return m_state; }
+
+	void App::setOverlayVisible(bool visible) { m_overlayVisible = visible; }
+
+	bool App::overlayVisible() const { return m_overlayVisible; }
 }
\ No newline at end of file
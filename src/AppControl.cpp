@@ -1,6 +1,7 @@
 #include "AppControl.h"
 
 #include "Action.h"
+#include "Profiler.h"
 
 namespace panda
 {
@@ -12,6 +13,13 @@ namespace panda
 
 	void AppControl::action(const Action& action)
 	{
+		PANDA_PROFILE_SCOPE("AppControl::action");
+		if (action == Action::ToggleOverlay)
+		{
+			m_app.setOverlayVisible(!m_app.overlayVisible());
+			return;
+		}
+
 		if (action == Action::Exit)
 		{
 			App::State nextState = App::State::Pause;
@@ -1,18 +1,29 @@
 #include "AppRender.h"
 
+#include "Console.h"
+
 namespace panda
 {
-	AppRender::AppRender(const App& app, Renders renders)
+	AppRender::AppRender(const App& app, Renders renders, Console& console)
 		: m_app(app)
 		, m_renders(std::move(renders))
+		, m_console(console)
 	{
 	}
 
 	void AppRender::update()
 	{
+		m_console.begin();
+
 		if (m_app.state() == App::State::Game)
 			m_renders.gameRender.update();
 		else if (m_app.state() == App::State::Pause)
 			m_renders.menuRender.update();
+
+		// hidden overlay costs nothing, it is not even asked for stats
+		if (m_app.overlayVisible())
+			m_renders.overlayRender.update();
+
+		m_console.end();
 	}
 }
\ No newline at end of file
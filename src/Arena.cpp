@@ -0,0 +1,44 @@
+#include "Arena.h"
+
+#include <cstdint>
+
+namespace panda
+{
+	Arena::Arena(void* buffer, size_t size, std::pmr::memory_resource* upstream)
+		: m_buffer(static_cast<std::byte*>(buffer))
+		, m_size(size)
+		, m_upstream(upstream)
+	{
+	}
+
+	void* Arena::do_allocate(size_t bytes, size_t alignment)
+	{
+		uintptr_t address = reinterpret_cast<uintptr_t>(m_buffer + m_used);
+		size_t padding = (alignment - address % alignment) % alignment;
+		if (padding + bytes <= m_size - m_used)
+		{
+			void* pointer = m_buffer + m_used + padding;
+			m_used += padding + bytes;
+			return pointer;
+		}
+
+		void* pointer = m_upstream->allocate(bytes, alignment);
+		m_overflow += bytes;
+		return pointer;
+	}
+
+	void Arena::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+	{
+		std::byte* first = static_cast<std::byte*>(pointer);
+		if (first >= m_buffer && first < m_buffer + m_size)
+		{
+			// only the most recent block can be given back, anything else stays until the arena goes
+			if (first + bytes == m_buffer + m_used)
+				m_used -= bytes;
+			return;
+		}
+
+		m_upstream->deallocate(pointer, bytes, alignment);
+		m_overflow -= bytes;
+	}
+}
@@ -2,36 +2,64 @@
 
 #include "Card.h"
 
+#include <algorithm>
 #include <iterator>
 
 namespace panda
 {
-	CardStack::CardStack(std::vector<Card>&& cards)
-		: m_cards(cards)
+	CardStack::CardStack(std::pmr::vector<Card>&& cards)
+		: m_cards(std::move(cards))
 	{
+		rebuildMasks();
 	}
 
-	std::optional<CardStack> CardStack::take(size_t index)
+	CardStack::CardStack(const CardStack& other, const allocator_type& allocator)
+		: m_cards(other.m_cards, allocator)
+		, m_openMask(other.m_openMask)
+		, m_cardSet(other.m_cardSet)
+		, m_openCardSet(other.m_openCardSet)
+	{
+	}
+
+	CardStack::CardStack(CardStack&& other, const allocator_type& allocator)
+		: m_cards(std::move(other.m_cards), allocator)
+		, m_openMask(other.m_openMask)
+		, m_cardSet(other.m_cardSet)
+		, m_openCardSet(other.m_openCardSet)
+	{
+	}
+
+	std::optional<CardStack> CardStack::take(size_t index, const allocator_type& allocator)
 	{
 		if (index >= m_cards.size())
 			return {};
 
-		std::vector<Card> out;
 		auto first = m_cards.begin();
 		std::advance(first, index);
-		std::move(first, m_cards.end(), std::back_inserter(out));
+		CardStack taken(std::pmr::vector<Card>(first, m_cards.end(), allocator));
 
-		// erase cards from original stack
+		// erase cards from original stack, the taken cards leave the sets unless a copy stays behind
+		bool unique = hasUniqueCards();
 		m_cards.resize(index);
-		return std::optional<CardStack>(std::move(out));
+		m_openMask &= lowBits(index);
+		if (unique)
+		{
+			m_cardSet &= ~taken.m_cardSet;
+			m_openCardSet &= ~taken.m_cardSet;
+		}
+		else
+		{
+			rebuildMasks();
+		}
+		return std::optional<CardStack>(std::move(taken));
 	}
 
-	std::optional<CardStack> CardStack::takeTop()
+	std::optional<CardStack> CardStack::takeTop(const allocator_type& allocator)
 	{
 		if (m_cards.empty())
 			return {};
 
-		return take(m_cards.size() - 1);
+		return take(m_cards.size() - 1, allocator);
 	}
 
 	std::optional<Card> CardStack::top() const
@@ -42,8 +70,6 @@ namespace panda
 		return m_cards.back();
 	}
 
-	size_t CardStack::topIndex() const { return m_cards.size() - 1; }
-
 	std::optional<Card> CardStack::bottom() const
 	{
 		if (m_cards.empty())
@@ -54,7 +80,10 @@ namespace panda
 
 	std::optional<size_t> CardStack::firstOpenCard() const
 	{
-		for (size_t i = 0; i < m_cards.size(); ++i)
+		if (m_openMask != 0)
+			return lowestBit(m_openMask);
+
+		for (size_t i = 64; i < m_cards.size(); ++i)
 		{
 			if (m_cards[i].state == Card::State::Open)
 				return i;
@@ -62,20 +91,59 @@ namespace panda
 		return {};    // if all cards are flipped, return empty
 	}
 
-	const std::vector<Card>& CardStack::cards() const { return m_cards; }
+	bool CardStack::isOpen(size_t index) const
+	{
+		if (index < 64)
+			return (m_openMask >> index) & 1;
+		return index < m_cards.size() && m_cards[index].state == Card::State::Open;
+	}
+
+	size_t CardStack::openCount(size_t firstCardIndex) const
+	{
+		size_t count = firstCardIndex < 64 ? bitCount(m_openMask & ~lowBits(firstCardIndex)) : 0;
+		for (size_t i = std::max<size_t>(firstCardIndex, 64); i < m_cards.size(); ++i)
+			count += m_cards[i].state == Card::State::Open ? 1 : 0;
+		return count;
+	}
+
+	size_t CardStack::openRunLength() const
+	{
+		size_t size = m_cards.size();
+		if (size <= 64)
+		{
+			// the highest closed card ends the run
+			uint64_t closed = ~m_openMask & lowBits(size);
+			return closed == 0 ? size : size - 1 - highestBit(closed);
+		}
+
+		size_t length = 0;
+		while (length < size && m_cards[size - 1 - length].state == Card::State::Open)
+			++length;
+		return length;
+	}
 
 	bool CardStack::append(CardStack&& stack)
 	{
+		size_t first = m_cards.size();
 		m_cards.insert(m_cards.end(), std::make_move_iterator(stack.m_cards.begin()), std::make_move_iterator(stack.m_cards.end()));
+		if (first < 64)
+			m_openMask |= stack.m_openMask << first;
+		m_cardSet |= stack.m_cardSet;
+		m_openCardSet |= stack.m_openCardSet;
 		return true;
 	}
 
-	void CardStack::invertOrder() { std::reverse(m_cards.begin(), m_cards.end()); }
+	void CardStack::invertOrder()
+	{
+		std::reverse(m_cards.begin(), m_cards.end());
+		rebuildMasks();
+	}
 
 	void CardStack::flipAll()
 	{
 		for (auto& card : m_cards)
 			card.flip();
+		rebuildMasks();
 	}
 
 	void CardStack::flipTop()
@@ -83,8 +151,35 @@ namespace panda
 		if (m_cards.empty())
 			return;
 
-		m_cards.back().flip();
+		Card& card = m_cards.back();
+		card.flip();
+
+		size_t index = m_cards.size() - 1;
+		if (index < 64)
+			m_openMask ^= uint64_t(1) << index;
+		if (card.state == Card::State::Open)
+			m_openCardSet |= cardBit(card);
+		else if (hasUniqueCards())
+			m_openCardSet &= ~cardBit(card);
+		else
+			rebuildMasks();
 	}
 
-	size_t CardStack::size() const { return m_cards.size(); }
-}
\ No newline at end of file
+	void CardStack::rebuildMasks()
+	{
+		m_openMask = 0;
+		m_cardSet = 0;
+		m_openCardSet = 0;
+		for (size_t i = 0; i < m_cards.size(); ++i)
+		{
+			const Card& card = m_cards[i];
+			CardSet bit = cardBit(card);
+			m_cardSet |= bit;
+			if (card.state != Card::State::Open)
+				continue;
+			m_openCardSet |= bit;
+			if (i < 64)
+				m_openMask |= uint64_t(1) << i;
+		}
+	}
+}
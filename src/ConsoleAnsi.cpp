@@ -0,0 +1,261 @@
+#include "ConsoleAnsi.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+
+namespace panda
+{
+	namespace
+	{
+		// Unicode code points of the code page 437 glyphs, as the Windows console shows them
+		const std::array<uint16_t, 256>& codePage437()
+		{
+			static const std::array<uint16_t, 256> table = []() {
+				std::array<uint16_t, 256> codes{};
+				const uint16_t low[32] = {0x0020, 0x263A, 0x263B, 0x2665, 0x2666, 0x2663, 0x2660, 0x2022, 0x25D8, 0x25CB, 0x25D9,
+										  0x2642, 0x2640, 0x266A, 0x266B, 0x263C, 0x25BA, 0x25C4, 0x2195, 0x203C, 0x00B6, 0x00A7,
+										  0x25AC, 0x21A8, 0x2191, 0x2193, 0x2192, 0x2190, 0x221F, 0x2194, 0x25B2, 0x25BC};
+				const uint16_t high[128] = {
+					0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7, 0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+					0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9, 0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+					0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA, 0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+					0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+					0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F, 0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+					0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B, 0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+					0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4, 0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+					0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248, 0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0};
+				for (size_t i = 0; i < 32; ++i)
+					codes[i] = low[i];
+				for (size_t i = 32; i < 127; ++i)
+					codes[i] = static_cast<uint16_t>(i);
+				codes[127] = 0x2302;
+				for (size_t i = 0; i < 128; ++i)
+					codes[128 + i] = high[i];
+				return codes;
+			}();
+			return table;
+		}
+
+		template <class String>
+		void appendUtf8(String& out, char text)
+		{
+			uint16_t code = codePage437()[static_cast<unsigned char>(text)];
+			if (code < 0x80)
+			{
+				out += static_cast<char>(code);
+			}
+			else if (code < 0x800)
+			{
+				out += static_cast<char>(0xC0 | (code >> 6));
+				out += static_cast<char>(0x80 | (code & 0x3F));
+			}
+			else
+			{
+				out += static_cast<char>(0xE0 | (code >> 12));
+				out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (code & 0x3F));
+			}
+		}
+
+		// Windows attributes have blue in the low bit and red in the third, ANSI the other way around
+		int ansiColor(int color) { return (color & 0x1) << 2 | (color & 0x2) | (color & 0x4) >> 2; }
+
+		template <class String>
+		void appendColor(String& out, uint8_t color)
+		{
+			int fg = color & 0xF;
+			int bg = color >> 4;
+			out += "\x1b[";
+			out += std::to_string((fg & 0x8 ? 90 : 30) + ansiColor(fg));
+			out += ';';
+			out += std::to_string((bg & 0x8 ? 100 : 40) + ansiColor(bg));
+			out += 'm';
+		}
+
+		template <class String>
+		void appendCursor(String& out, int x, int y)
+		{
+			out += "\x1b[";
+			out += std::to_string(y + 1);
+			out += ';';
+			out += std::to_string(x + 1);
+			out += 'H';
+		}
+
+		// Unchanged cells up to this many are written again rather than jumped over, a cursor move costs about as much
+		const int maxRewrite = 4;
+	}
+
+	ConsoleAnsi::ConsoleAnsi(int width, int height, std::pmr::memory_resource* resource)
+		: m_width(width)
+		, m_height(height)
+		, m_back(static_cast<size_t>(width * height), resource)
+		, m_front(static_cast<size_t>(width * height), resource)
+		, m_output(resource)
+	{
+		// room for a frame that changes every cell once, so the buffer rarely has to grow
+		m_output.reserve(static_cast<size_t>(width * height) * 2);
+		// hide the cursor, it would blink wherever the last cell was written
+		m_output = "\x1b[?25l";
+		invalidate();
+	}
+
+	void ConsoleAnsi::setClearColor(int color) { m_clearColor = color; }
+
+	void ConsoleAnsi::begin()
+	{
+		m_frameStats = {};
+		std::fill(m_back.begin(), m_back.end(), Cell{' ', static_cast<uint8_t>(m_clearColor << 4)});
+	}
+
+	void ConsoleAnsi::end()
+	{
+		PANDA_PROFILE_SCOPE("Console::end");
+		encodeChanges();
+		m_lastFrameStats = m_frameStats;
+	}
+
+	void ConsoleAnsi::beginUpdate() { m_back = m_front; }
+
+	void ConsoleAnsi::endUpdate() { encodeChanges(); }
+
+	int ConsoleAnsi::width() const { return m_width; }
+
+	int ConsoleAnsi::height() const { return m_height; }
+
+	void ConsoleAnsi::setDrawColor(int fgColor, int bgColor)
+	{
+		m_fgColor = fgColor;
+		m_bgColor = bgColor;
+	}
+
+	void ConsoleAnsi::setDrawColor(int fgColor) { setDrawColor(fgColor, m_clearColor); }
+
+	void ConsoleAnsi::draw(std::string_view str, int x, int y) const
+	{
+		for (size_t i = 0; i < str.size(); ++i)
+			put(str[i], x + static_cast<int>(i), y);
+	}
+
+	void ConsoleAnsi::draw(char text, int x, int y) const { put(text, x, y); }
+
+	void ConsoleAnsi::drawRect(int x, int y, int width, int height) const
+	{
+		for (int j = 0; j < height; ++j)
+		{
+			for (int i = 0; i < width; ++i)
+				put(' ', x + i, y + j);
+		}
+	}
+
+	void ConsoleAnsi::drawRectOutline(int x, int y, int width, int height, bool fill) const
+	{
+		// corners and edges from code page 437, as the Windows console draws them
+		put(char(218), x, y);
+		put(char(191), x + width - 1, y);
+		put(char(192), x, y + height - 1);
+		put(char(217), x + width - 1, y + height - 1);
+		for (int i = 1; i < width - 1; ++i)
+		{
+			put(char(196), x + i, y);
+			put(char(196), x + i, y + height - 1);
+		}
+		for (int j = 1; j < height - 1; ++j)
+		{
+			put(char(179), x, y + j);
+			put(char(179), x + width - 1, y + j);
+		}
+		if (fill)
+			drawRect(x + 1, y + 1, width - 2, height - 2);
+	}
+
+	void ConsoleAnsi::clear()
+	{
+		m_output += "\x1b[0m\x1b[2J";
+		invalidate();
+	}
+
+	ConsoleStats ConsoleAnsi::stats() const { return m_lastFrameStats; }
+
+	void ConsoleAnsi::consume(size_t bytes)
+	{
+		if (bytes >= m_output.size())
+			m_output.clear();
+		else
+			m_output.erase(0, bytes);
+	}
+
+	void ConsoleAnsi::invalidate()
+	{
+		// no drawn cell has a zero character, so every cell differs from this
+		std::fill(m_front.begin(), m_front.end(), Cell{'\0', 0});
+	}
+
+	void ConsoleAnsi::put(char text, int x, int y) const
+	{
+		m_frameStats.cellsWritten++;
+		if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+			return;
+		m_back[static_cast<size_t>(y * m_width + x)] = Cell{text, static_cast<uint8_t>((m_fgColor & 0xF) | (m_bgColor & 0xF) << 4)};
+	}
+
+	std::string ConsoleAnsi::keyframe() const
+	{
+		// the terminal may show anything, it is cleared and every cell is written
+		std::string out = "\x1b[?25l\x1b[0m\x1b[2J";
+		encodeCells(out, m_front, nullptr);
+		return out;
+	}
+
+	void ConsoleAnsi::encodeChanges()
+	{
+		size_t before = m_output.size();
+		encodeCells(m_output, m_back, &m_front);
+		m_front = m_back;
+		m_frameStats.bytesFlushed += m_output.size() - before;
+	}
+
+	template <class String>
+	void ConsoleAnsi::encodeCells(String& out, const std::pmr::vector<Cell>& cells, const std::pmr::vector<Cell>* shown) const
+	{
+		// cursor and color are unknown at the start of a frame, the first change sets both
+		int cursorX = -1;
+		int cursorY = -1;
+		int color = -1;
+		for (int y = 0; y < m_height; ++y)
+		{
+			const Cell* back = &cells[static_cast<size_t>(y * m_width)];
+			const Cell* front = shown ? &(*shown)[static_cast<size_t>(y * m_width)] : nullptr;
+			for (int x = 0; x < m_width; ++x)
+			{
+				if (front && back[x] == front[x])
+					continue;
+
+				// short runs of unchanged cells in the same color are cheaper to write again than to jump over
+				bool rewrite = cursorY == y && x > cursorX && x - cursorX <= maxRewrite;
+				for (int i = cursorX; rewrite && i < x; ++i)
+					rewrite = back[i].color == color;
+				if (rewrite)
+				{
+					for (int i = cursorX; i < x; ++i)
+						appendUtf8(out, back[i].text);
+				}
+				else if (cursorY != y || cursorX != x)
+				{
+					appendCursor(out, x, y);
+				}
+
+				if (back[x].color != color)
+				{
+					color = back[x].color;
+					appendColor(out, back[x].color);
+				}
+				appendUtf8(out, back[x].text);
+				cursorX = x + 1;
+				cursorY = y;
+			}
+		}
+	}
+}
@@ -0,0 +1,46 @@
+#include "ConsoleNull.h"
+
+namespace panda
+{
+	ConsoleNull::ConsoleNull(int width, int height)
+		: m_width(width)
+		, m_height(height)
+	{
+	}
+
+	void ConsoleNull::setClearColor(int) {}
+
+	void ConsoleNull::begin() { m_frameStats = {}; }
+
+	void ConsoleNull::end() { m_lastFrameStats = m_frameStats; }
+
+	void ConsoleNull::beginUpdate() {}
+
+	void ConsoleNull::endUpdate() {}
+
+	int ConsoleNull::width() const { return m_width; }
+
+	int ConsoleNull::height() const { return m_height; }
+
+	void ConsoleNull::setDrawColor(int, int) {}
+
+	void ConsoleNull::setDrawColor(int) {}
+
+	void ConsoleNull::draw(std::string_view str, int, int) const { m_frameStats.cellsWritten += str.size(); }
+
+	void ConsoleNull::draw(char, int, int) const { m_frameStats.cellsWritten++; }
+
+	void ConsoleNull::drawRect(int, int, int width, int height) const { m_frameStats.cellsWritten += width * height; }
+
+	void ConsoleNull::drawRectOutline(int, int, int width, int height, bool fill) const
+	{
+		if (fill)
+			m_frameStats.cellsWritten += width * height;
+		else
+			m_frameStats.cellsWritten += 2 * (width + height) - 4;
+	}
+
+	void ConsoleNull::clear() {}
+
+	ConsoleStats ConsoleNull::stats() const { return m_lastFrameStats; }
+}
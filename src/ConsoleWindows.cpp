@@ -1,5 +1,7 @@
 ﻿#include "ConsoleWindows.h"
 
+#include "Profiler.h"
+
 #ifdef WIN32
 #	define WIN32_LEAN_AND_MEAN
 #	include <Windows.h>
@@ -56,13 +58,31 @@ namespace panda
 
 	void ConsoleWindows::setClearColor(int color) { m_clearColor = color; }
 
-	void ConsoleWindows::begin() { clear(m_clearColor); }
+	void ConsoleWindows::begin()
+	{
+		m_frameStats = {};
+		clear(m_clearColor);
+	}
 
 	void ConsoleWindows::end()
 	{
+		PANDA_PROFILE_SCOPE("Console::end");
 		//printColors();
 		//printAscii();
 		swapBuffers();
+		m_lastFrameStats = m_frameStats;
+	}
+
+	void ConsoleWindows::beginUpdate()
+	{
+		// draw calls write to the back buffer, point it to the displayed one so changes show straight away
+		m_backBuffer = m_backBuffer == m_firstBuffer ? m_secondBuffer : m_firstBuffer;
+	}
+
+	void ConsoleWindows::endUpdate()
+	{
+		// restore the back buffer, the next full frame is drawn off screen again
+		m_backBuffer = m_backBuffer == m_firstBuffer ? m_secondBuffer : m_firstBuffer;
 	}
 
 	bool ConsoleWindows::clear(int color)
@@ -83,6 +103,7 @@ namespace panda
 		WORD attribute;
 		attribute = this->color(0, color);    // change the background color
 		FillConsoleOutputAttribute(m_backBuffer, attribute, length, topLeft, &written);
+		m_frameStats.bytesFlushed += length * (sizeof(char) + sizeof(WORD));
 
 
 		// Move the cursor back to the top left for the next sequence of writes
@@ -102,7 +123,7 @@ namespace panda
 
 	void ConsoleWindows::setDrawColor(int fgColor) { setDrawColor(fgColor, m_clearColor); }
 
-	void ConsoleWindows::draw(const std::string& str, int x, int y) const
+	void ConsoleWindows::draw(std::string_view str, int x, int y) const
 	{
 		setupColor();
 		setCursorPosition(x, y);
@@ -183,6 +204,16 @@ namespace panda
 
 	void ConsoleWindows::clear() { system("cls"); }
 
+	ConsoleStats ConsoleWindows::stats() const
+	{
+		ConsoleStats stats = m_lastFrameStats;
+		// only queried when someone asks, drawing a frame does not pay for it
+		DWORD events = 0;
+		if (GetNumberOfConsoleInputEvents(GetStdHandle(STD_INPUT_HANDLE), &events))
+			stats.inputQueueDepth = events;
+		return stats;
+	}
+
 	void ConsoleWindows::printColors() const
 	{
 		for (int i = 0; i < 0xFF; ++i)
@@ -209,17 +240,21 @@ namespace panda
 
 	int ConsoleWindows::color(int foreground, int background) const { return foreground + background * 16; }
 
-	void ConsoleWindows::writeBuffer(const std::string& str) const
+	void ConsoleWindows::writeBuffer(std::string_view str) const
 	{
 		// write to back buffer
 		DWORD written;
-		WriteConsole(m_backBuffer, str.c_str(), static_cast<int>(str.length()), &written, nullptr);
+		WriteConsole(m_backBuffer, str.data(), static_cast<int>(str.length()), &written, nullptr);
+		m_frameStats.cellsWritten += str.length();
+		m_frameStats.bytesFlushed += str.length();
 	}
 
 	void ConsoleWindows::writeBuffer(char c) const
 	{
 		DWORD written;
 		WriteConsole(m_backBuffer, &c, 1, &written, nullptr);
+		m_frameStats.cellsWritten++;
+		m_frameStats.bytesFlushed++;
 	}
 
 	bool ConsoleWindows::setSize()
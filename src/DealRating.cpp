@@ -0,0 +1,290 @@
+#include "DealRating.h"
+
+#include "CardSet.h"
+#include "FilesystemUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace panda
+{
+	namespace DealRating
+	{
+		namespace
+		{
+			// "SRAT" then the version, written in host byte order like the columns
+			constexpr uint32_t fileMagic = 0x54415253;
+			constexpr uint32_t fileVersion = 1;
+
+			struct Header
+			{
+				uint32_t magic = fileMagic;
+				uint32_t version = fileVersion;
+				uint32_t count = 0;
+				uint32_t firstSeed = 0;
+				uint8_t drawCount = 0;
+				uint8_t solved = 0;
+				uint8_t padding[2] = {};
+			};
+
+			// bytes per deal of every column, in file order
+			constexpr size_t seedBytes = sizeof(uint32_t);
+			constexpr size_t featureBytes = 4 * sizeof(uint8_t);
+			constexpr size_t resultBytes = sizeof(uint8_t);
+			constexpr size_t nodeBytes = sizeof(uint32_t);
+			constexpr size_t scoreBytes = sizeof(uint16_t);
+			constexpr size_t difficultyBytes = sizeof(Difficulty);
+			constexpr size_t dealBytes = seedBytes + featureBytes + resultBytes + nodeBytes + scoreBytes + difficultyBytes;
+
+			uint8_t saturate(size_t value) { return static_cast<uint8_t>(std::min<size_t>(value, 255)); }
+
+			template <class T>
+			void writeColumn(std::ofstream& file, const std::vector<T>& column)
+			{
+				file.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+			}
+
+			template <class T>
+			bool readColumn(std::ifstream& file, std::vector<T>& column)
+			{
+				return static_cast<bool>(file.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T))));
+			}
+
+			std::optional<Header> readHeader(std::ifstream& file)
+			{
+				Header header;
+				if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+					return std::nullopt;
+				if (header.magic != fileMagic || header.version != fileVersion)
+					return std::nullopt;
+
+				// the columns are sized from the count, a count the file is too short for is a broken file and no reason to allocate
+				file.seekg(0, std::ios::end);
+				std::streamoff length = file.tellg();
+				file.seekg(static_cast<std::streamoff>(sizeof(Header)));
+				if (length < 0 || static_cast<uint64_t>(length) < sizeof(Header) + static_cast<uint64_t>(header.count) * dealBytes)
+					return std::nullopt;
+				return header;
+			}
+		}
+
+		Features extractFeatures(const Game& game)
+		{
+			Features features;
+			const Stock& stock = game.stock();
+			const std::pmr::vector<CardStack>& stacks = game.stacks();
+
+			size_t buriedAces = 0;
+			for (int suit = 0; suit < 4; ++suit)
+			{
+				std::optional<Game::CardLocation> location = game.locate(Card(1, static_cast<Card::Suit>(suit)));
+				if (!location)
+					continue;
+				if (game.isCentralStack(location->stack))
+					buriedAces += stacks[location->stack].size() - 1 - location->index;
+				else if (game.isClosedStack(location->stack))
+					buriedAces += stock.closedSize() - 1 - location->index;    // cards drawn before it
+			}
+			features.buriedAces = saturate(buriedAces);
+
+			// a king on closed cards has to find an empty stack before they can be reached
+			size_t closedAboveKings = 0;
+			for (size_t stackIndex : game.centralStacksIndices())
+			{
+				size_t closedSoFar = 0;
+				for (const Card& card : stacks[stackIndex].cards())
+				{
+					if (card.number == 13)
+						closedAboveKings += closedSoFar;
+					if (card.state == Card::State::Closed)
+						++closedSoFar;
+				}
+			}
+			features.closedAboveKings = saturate(closedAboveKings);
+
+			// the first pass through the stock only shows every drawCount-th card
+			size_t stockPlayable = 0;
+			CardSet openCards = game.openCentralCards();
+			size_t drawCount = std::max<size_t>(1, stock.drawCount());
+			const std::pmr::vector<Card>& stockCards = stock.cards();
+			for (size_t i = stock.openSize(); i < stockCards.size(); ++i)
+			{
+				size_t position = i - stock.openSize();
+				if ((position + 1) % drawCount != 0 && i + 1 != stockCards.size())
+					continue;
+				const Card& card = stockCards[i];
+				if (card.number == 1 || (Game::centralParents(card) & openCards) != 0)
+					++stockPlayable;
+			}
+			features.stockPlayable = saturate(stockPlayable);
+
+			std::vector<Move> moves = game.legalMoves();
+			features.openingMoves = saturate(std::count_if(moves.begin(), moves.end(), [](const Move& move) { return move.type == Move::Type::Cards; }));
+			return features;
+		}
+
+		uint16_t score(const Features& features, std::optional<Solver::Result> result, size_t nodes)
+		{
+			int value = 2 * features.buriedAces + 3 * features.closedAboveKings - 4 * features.stockPlayable - 6 * features.openingMoves;
+			value = std::max(0, value + 200);
+
+			// search effort dominates: deals the solver needs more nodes for are harder to find a way through
+			if (result)
+			{
+				// the pruned search running out is no proof of a loss, only that no easy way through was found
+				if (*result == Solver::Result::LimitReached || *result == Solver::Result::NotFound)
+					value += 3000;
+				else
+					value += static_cast<int>(100.0 * std::log2(static_cast<double>(nodes) + 1.0));
+			}
+			return static_cast<uint16_t>(std::min(value, 65535));
+		}
+
+		void Table::resize(size_t size)
+		{
+			seeds.resize(size);
+			buriedAces.resize(size);
+			closedAboveKings.resize(size);
+			stockPlayable.resize(size);
+			openingMoves.resize(size);
+			results.resize(size);
+			nodes.resize(size);
+			scores.resize(size);
+			difficulties.resize(size);
+		}
+
+		void Table::classify()
+		{
+			std::vector<uint16_t> sorted(scores.begin(), scores.end());
+			std::sort(sorted.begin(), sorted.end());
+
+			uint16_t easyLimit = sorted.empty() ? 0 : sorted[sorted.size() / 3];
+			uint16_t mediumLimit = sorted.empty() ? 0 : sorted[sorted.size() * 2 / 3];
+			for (size_t i = 0; i < size(); ++i)
+			{
+				if (scores[i] < easyLimit)
+					difficulties[i] = Difficulty::Easy;
+				else if (scores[i] < mediumLimit)
+					difficulties[i] = Difficulty::Medium;
+				else
+					difficulties[i] = Difficulty::Hard;
+			}
+		}
+
+		bool Table::save(const std::filesystem::path& path) const
+		{
+			std::ofstream file(path, std::ios::binary);
+			if (!file.is_open())
+				return false;
+
+			Header header;
+			header.count = static_cast<uint32_t>(size());
+			header.firstSeed = firstSeed;
+			header.drawCount = drawCount;
+			header.solved = solved ? 1 : 0;
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+			writeColumn(file, seeds);
+			writeColumn(file, buriedAces);
+			writeColumn(file, closedAboveKings);
+			writeColumn(file, stockPlayable);
+			writeColumn(file, openingMoves);
+			writeColumn(file, results);
+			writeColumn(file, nodes);
+			writeColumn(file, scores);
+			writeColumn(file, difficulties);
+			return static_cast<bool>(file);
+		}
+
+		std::optional<Table> Table::load(const std::filesystem::path& path)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open())
+				return std::nullopt;
+			std::optional<Header> header = readHeader(file);
+			if (!header)
+				return std::nullopt;
+
+			Table table;
+			table.firstSeed = header->firstSeed;
+			table.drawCount = header->drawCount;
+			table.solved = header->solved != 0;
+			table.resize(header->count);
+
+			bool ok = readColumn(file, table.seeds) && readColumn(file, table.buriedAces) && readColumn(file, table.closedAboveKings) &&
+					  readColumn(file, table.stockPlayable) && readColumn(file, table.openingMoves) && readColumn(file, table.results) &&
+					  readColumn(file, table.nodes) && readColumn(file, table.scores) && readColumn(file, table.difficulties);
+			if (!ok)
+				return std::nullopt;
+			return table;
+		}
+
+		std::optional<unsigned int> pickSeed(const std::filesystem::path& path, Difficulty difficulty, size_t drawCount, std::mt19937& rng)
+		{
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open())
+				return std::nullopt;
+			std::optional<Header> header = readHeader(file);
+			if (!header || header->count == 0)
+				return std::nullopt;
+
+			// a deal plays differently with another draw count, its rating does not carry over
+			if (header->drawCount != drawCount)
+				return std::nullopt;
+
+			// the difficulty column is the last one, the seeds come right after the header
+			size_t count = header->count;
+			std::vector<Difficulty> difficulties(count);
+			size_t difficultyOffset = sizeof(Header) + count * (seedBytes + featureBytes + resultBytes + nodeBytes + scoreBytes);
+			file.seekg(static_cast<std::streamoff>(difficultyOffset));
+			if (!readColumn(file, difficulties))
+				return std::nullopt;
+
+			size_t matches = std::count(difficulties.begin(), difficulties.end(), difficulty);
+			if (matches == 0)
+				return std::nullopt;
+
+			size_t pick = std::uniform_int_distribution<size_t>(0, matches - 1)(rng);
+			size_t index = 0;
+			for (; index < count; ++index)
+			{
+				if (difficulties[index] == difficulty && pick-- == 0)
+					break;
+			}
+
+			uint32_t seed = 0;
+			file.clear();
+			file.seekg(static_cast<std::streamoff>(sizeof(Header) + index * seedBytes));
+			if (!file.read(reinterpret_cast<char*>(&seed), sizeof(seed)))
+				return std::nullopt;
+			return seed;
+		}
+
+		std::filesystem::path defaultPath() { return FilesystemUtils::appDataPath() / "Soliterminal" / "ratings.bin"; }
+
+		const char* difficultyName(Difficulty difficulty)
+		{
+			switch (difficulty)
+			{
+			case Difficulty::Easy:
+				return "easy";
+			case Difficulty::Medium:
+				return "medium";
+			case Difficulty::Hard:
+				return "hard";
+			}
+			return "";
+		}
+
+		std::optional<Difficulty> parseDifficulty(const std::string& name)
+		{
+			for (Difficulty difficulty : {Difficulty::Easy, Difficulty::Medium, Difficulty::Hard})
+			{
+				if (name == difficultyName(difficulty))
+					return difficulty;
+			}
+			return std::nullopt;
+		}
+	}
+}
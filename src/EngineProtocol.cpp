@@ -0,0 +1,373 @@
+#include "EngineProtocol.h"
+
+#include "GameFileIO.h"
+#include "Policy.h"
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <limits>
+#include <random>
+
+namespace panda
+{
+	namespace
+	{
+		// Splits the first word off the text, the text keeps the rest
+		std::string_view nextWord(std::string_view& text)
+		{
+			size_t start = text.find_first_not_of(" \t");
+			if (start == std::string_view::npos)
+			{
+				text = {};
+				return {};
+			}
+			size_t end = text.find_first_of(" \t", start);
+			if (end == std::string_view::npos)
+				end = text.size();
+			std::string_view word = text.substr(start, end - start);
+			text.remove_prefix(end);
+			return word;
+		}
+
+		template <class Number>
+		std::optional<Number> parseNumber(std::string_view text)
+		{
+			Number number{};
+			auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+			if (error != std::errc() || end != text.data() + text.size())
+				return std::nullopt;
+			return number;
+		}
+
+		void appendCard(std::string& out, const Card& card)
+		{
+			static const char numbers[] = "A23456789TJQK";
+			static const char suits[] = "HDCS";
+			bool closed = card.state == Card::State::Closed;
+			char number = card.number >= 1 && card.number <= 13 ? numbers[card.number - 1] : '?';
+			char suit = suits[static_cast<size_t>(card.suit)];
+			out += closed ? static_cast<char>(std::tolower(number)) : number;
+			out += closed ? static_cast<char>(std::tolower(suit)) : suit;
+		}
+
+		const char* stateName(Game::State state)
+		{
+			switch (state)
+			{
+			case Game::State::Playing:
+				return "playing";
+			case Game::State::Win:
+				return "win";
+			case Game::State::Lose:
+				return "lose";
+			}
+			return "playing";
+		}
+
+		const char* resultName(Solver::Result result)
+		{
+			switch (result)
+			{
+			case Solver::Result::Solved:
+				return "solved";
+			case Solver::Result::Unsolvable:
+				return "unsolvable";
+			case Solver::Result::NotFound:
+				return "notfound";
+			case Solver::Result::LimitReached:
+				return "limit";
+			}
+			return "limit";
+		}
+	}
+
+	EngineProtocol::EngineProtocol(std::ostream& out)
+		: m_out(out)
+		, m_game(Game::createRandomGame(1))
+	{
+		m_game.setDrawCount(3);
+	}
+
+	EngineProtocol::~EngineProtocol() { stopSearch(); }
+
+	void EngineProtocol::run(std::istream& in)
+	{
+		std::string line;
+		while (std::getline(in, line))
+		{
+			if (!execute(line))
+			{
+				stopSearch();
+				break;
+			}
+
+			// answers of pipelined commands go out together, one write instead of one per command
+			if (in.rdbuf()->in_avail() <= 0)
+			{
+				std::lock_guard<std::mutex> lock(m_outMutex);
+				m_out.flush();
+			}
+		}
+
+		// at the end of the input a running search is finished rather than cut short
+		if (m_search.joinable())
+			m_search.join();
+		std::lock_guard<std::mutex> lock(m_outMutex);
+		m_out.flush();
+	}
+
+	bool EngineProtocol::execute(std::string_view line)
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.remove_suffix(1);
+
+		m_buffer.clear();
+		std::string_view arguments = line;
+		std::string_view command = nextWord(arguments);
+		if (command.empty())
+			return true;
+
+		if (command == "play")
+			play(arguments);
+		else if (command == "moves")
+			legalMoves();
+		else if (command == "state")
+			m_buffer.append("state ").append(stateName(m_game.state())).append(" hash ").append(std::to_string(m_game.hash())).append("\n");
+		else if (command == "position")
+			position(arguments);
+		else if (command == "go")
+			go(arguments);
+		else if (command == "stop")
+			stopSearch();
+		else if (command == "isready")
+			m_buffer = "readyok\n";
+		else if (command == "board")
+			board();
+		else if (command == "setoption")
+			setOption(arguments);
+		else if (command == "protocol")
+			m_buffer = "id name Soliterminal\nprotocolok\n";
+		else if (command == "quit")
+			return false;
+		else
+			m_buffer.append("error unknown command ").append(command).append("\n");
+
+		if (!m_buffer.empty())
+		{
+			std::lock_guard<std::mutex> lock(m_outMutex);
+			m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+		}
+		return true;
+	}
+
+	std::string EngineProtocol::moveText(const Move& move)
+	{
+		switch (move.type)
+		{
+		case Move::Type::Draw:
+			return "d";
+		case Move::Type::Flip:
+			return "f" + std::to_string(move.sourceStack);
+		case Move::Type::Cards:
+			return std::to_string(move.sourceStack) + ":" + std::to_string(move.sourceCard) + "-" + std::to_string(move.destStack);
+		}
+		return "d";
+	}
+
+	std::optional<Move> EngineProtocol::parseMove(std::string_view text, const Game& game)
+	{
+		if (text == "d")
+			return Move{Move::Type::Draw};
+
+		size_t stackCount = game.stacks().size();
+		if (!text.empty() && text.front() == 'f')
+		{
+			std::optional<size_t> stack = parseNumber<size_t>(text.substr(1));
+			if (!stack || *stack >= stackCount || game.stack(*stack).size() == 0)
+				return std::nullopt;
+			return Move{Move::Type::Flip, *stack, game.stack(*stack).topIndex()};
+		}
+
+		size_t colon = text.find(':');
+		size_t dash = text.find('-');
+		if (colon == std::string_view::npos || dash == std::string_view::npos || dash < colon)
+			return std::nullopt;
+		std::optional<size_t> source = parseNumber<size_t>(text.substr(0, colon));
+		std::optional<size_t> card = parseNumber<size_t>(text.substr(colon + 1, dash - colon - 1));
+		std::optional<size_t> dest = parseNumber<size_t>(text.substr(dash + 1));
+		if (!source || !card || !dest || *source >= stackCount || *dest >= stackCount)
+			return std::nullopt;
+		return Move{Move::Type::Cards, *source, *card, *dest};
+	}
+
+	void EngineProtocol::position(std::string_view arguments)
+	{
+		std::string_view kind = nextWord(arguments);
+		if (kind == "seed")
+		{
+			std::string_view seedText = nextWord(arguments);
+			std::optional<unsigned int> seed = parseNumber<unsigned int>(seedText);
+			if (!seed)
+			{
+				m_buffer.append("error bad seed ").append(seedText).append("\n");
+				return;
+			}
+			m_game.reset(Game::createRandomGame(*seed));
+		}
+		else if (kind == "file" || kind == "saved")
+		{
+			std::optional<Game> loaded = kind == "saved" ? GameFileIO::loadGame() : GameFileIO::loadGame(std::string(nextWord(arguments)));
+			if (!loaded)
+			{
+				m_buffer = "error cannot load the game\n";
+				return;
+			}
+			m_game = std::move(*loaded);
+		}
+		else
+		{
+			m_buffer.append("error unknown position ").append(kind).append("\n");
+			return;
+		}
+
+		if (nextWord(arguments) == "moves")
+			play(arguments);
+	}
+
+	void EngineProtocol::setOption(std::string_view arguments)
+	{
+		std::string_view name;
+		std::string_view value;
+		while (!arguments.empty())
+		{
+			std::string_view word = nextWord(arguments);
+			if (word == "name")
+				name = nextWord(arguments);
+			else if (word == "value")
+				value = nextWord(arguments);
+		}
+
+		if (name == "draw" && (value == "1" || value == "3"))
+			m_game.setDrawCount(value == "1" ? 1 : 3);
+		else if (name == "autoplay" && (value == "true" || value == "false"))
+			m_game.setAutoPlay(value == "true");
+		else
+			m_buffer.append("error unknown option ").append(name).append(" ").append(value).append("\n");
+	}
+
+	void EngineProtocol::legalMoves()
+	{
+		m_buffer = "moves";
+		for (const Move& move : m_game.legalMoves())
+			m_buffer.append(" ").append(moveText(move));
+		m_buffer += '\n';
+	}
+
+	void EngineProtocol::play(std::string_view moves)
+	{
+		while (true)
+		{
+			std::string_view text = nextWord(moves);
+			if (text.empty())
+				return;
+			std::optional<Move> move = parseMove(text, m_game);
+			if (!move || !m_game.applyMove(*move))
+			{
+				m_buffer.append("error illegal move ").append(text).append("\n");
+				return;
+			}
+		}
+	}
+
+	void EngineProtocol::board()
+	{
+		const auto& stacks = m_game.stacks();
+		for (size_t i = 0; i < stacks.size(); ++i)
+		{
+			m_buffer.append("stack ").append(std::to_string(i));
+			for (const Card& card : stacks[i].cards())
+			{
+				m_buffer += ' ';
+				appendCard(m_buffer, card);
+			}
+			m_buffer += '\n';
+		}
+		m_buffer += "boardok\n";
+	}
+
+	void EngineProtocol::go(std::string_view arguments)
+	{
+		Solver::Limits limits;
+		while (!arguments.empty())
+		{
+			std::string_view word = nextWord(arguments);
+			if (word == "infinite")
+			{
+				limits.maxNodes = std::numeric_limits<size_t>::max();
+				limits.maxTime = std::chrono::hours(24);
+				continue;
+			}
+
+			std::string_view valueText = nextWord(arguments);
+			std::optional<size_t> value = parseNumber<size_t>(valueText);
+			if (!value || (word != "movetime" && word != "nodes"))
+			{
+				m_buffer.append("error bad go argument ").append(word).append(" ").append(valueText).append("\n");
+				return;
+			}
+			if (word == "movetime")
+				limits.maxTime = std::chrono::milliseconds(*value);
+			else
+				limits.maxNodes = *value;
+		}
+
+		stopSearch();
+		m_search = std::thread([this, game = m_game, limits]() { search(game, limits); });
+	}
+
+	void EngineProtocol::stopSearch()
+	{
+		if (!m_search.joinable())
+			return;
+		m_cancel = true;
+		m_search.join();
+		m_cancel = false;
+	}
+
+	void EngineProtocol::search(Game game, Solver::Limits limits)
+	{
+		auto start = std::chrono::steady_clock::now();
+		limits.cancelled = &m_cancel;
+		Solver solver(limits);
+		Solver::Solution solution = solver.solve(game);
+		auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+		std::string answer = "info result ";
+		answer.append(resultName(solution.result)).append(" nodes ").append(std::to_string(solution.nodes));
+		answer.append(" time ").append(std::to_string(milliseconds));
+		if (!solution.moves.empty())
+		{
+			answer += " pv";
+			for (const Move& move : solution.moves)
+				answer.append(" ").append(moveText(move));
+		}
+
+		// without a solution the greedy policy still names a move, as long as there is one worth playing
+		std::optional<Move> best;
+		if (!solution.moves.empty())
+		{
+			best = solution.moves.front();
+		}
+		else
+		{
+			std::mt19937 rng(0);
+			best = GreedyPolicy().choose(game, rng);
+		}
+		answer.append("\nbestmove ").append(best ? moveText(*best) : "none").append("\n");
+
+		std::lock_guard<std::mutex> lock(m_outMutex);
+		m_out.write(answer.data(), static_cast<std::streamsize>(answer.size()));
+		m_out.flush();
+	}
+}
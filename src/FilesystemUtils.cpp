@@ -1,6 +1,4 @@
-#pragma once
-
-#include <filesystem>
+#include "FilesystemUtils.h"
 
 #ifdef WIN32
 #	include "shlobj.h"
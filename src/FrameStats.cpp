@@ -0,0 +1,36 @@
+#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace panda
+{
+	void FrameStats::addFrame(double milliseconds)
+	{
+		m_frames[m_next] = milliseconds;
+		m_next = (m_next + 1) % capacity;
+		m_count = std::min(m_count + 1, capacity);
+	}
+
+	double FrameStats::last() const
+	{
+		if (m_count == 0)
+			return 0.0;
+		return m_frames[(m_next + capacity - 1) % capacity];
+	}
+
+	double FrameStats::percentile(double fraction) const
+	{
+		if (m_count == 0)
+			return 0.0;
+
+		// sorting a copy is fine, this is only computed while someone looks at it
+		std::array<double, capacity> sorted = m_frames;
+		size_t rank = static_cast<size_t>(std::ceil(fraction * m_count));
+		rank = std::clamp<size_t>(rank, 1, m_count) - 1;
+		std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.begin() + m_count);
+		return sorted[rank];
+	}
+
+	size_t FrameStats::size() const { return m_count; }
+}
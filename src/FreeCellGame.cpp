@@ -0,0 +1,301 @@
+#include "FreeCellGame.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cstdint>
+
+namespace panda
+{
+	namespace
+	{
+		uint64_t cardCode(const Card& card) { return static_cast<uint64_t>(card.number) | static_cast<uint64_t>(card.suit) << 4; }
+
+		// One FNV-1a step
+		uint64_t mix(uint64_t h, uint64_t value)
+		{
+			h ^= value;
+			h *= 1099511628211ull;
+			return h;
+		}
+	}
+
+	FreeCellGame::FreeCellGame(std::vector<CardStack>&& stacks)
+		: m_stacks(std::move(stacks))
+	{
+		assert(m_stacks.size() == stackCount);
+		m_stacks.resize(stackCount);
+		countStacks();
+	}
+
+	FreeCellGame FreeCellGame::createDeal(unsigned int dealNumber)
+	{
+		// the deck is ordered by number first, then clubs, diamonds, hearts and spades
+		static const std::array<Card::Suit, 4> suitOrder{Card::Suit::Club, Card::Suit::Diamond, Card::Suit::Heart, Card::Suit::Spade};
+		std::vector<Card> deck;
+		deck.reserve(52);
+		for (int i = 0; i < 52; ++i)
+			deck.emplace_back(i / 4 + 1, suitOrder[i % 4], Card::State::Open);
+
+		// the linear congruential generator of the Microsoft C runtime, which numbers the classic deals
+		uint32_t seed = dealNumber;
+		auto rand = [&seed]() {
+			seed = (seed * 214013u + 2531011u) & 0x7FFFFFFFu;
+			return seed >> 16;
+		};
+
+		// cards are dealt row by row, each picked card is replaced by the last one of the deck
+		std::array<std::pmr::vector<Card>, 8> central;
+		for (size_t i = 0; i < 52; ++i)
+		{
+			size_t left = 52 - i;
+			size_t pick = rand() % left;
+			central[i % 8].push_back(deck[pick]);
+			deck[pick] = deck[left - 1];
+		}
+
+		std::vector<CardStack> stacks(stackCount);
+		for (size_t i = 0; i < central.size(); ++i)
+			stacks[8 + i] = CardStack(std::move(central[i]));
+		return FreeCellGame(std::move(stacks));
+	}
+
+	size_t FreeCellGame::maxMovableCards(bool toEmptyStack) const
+	{
+		// every free cell holds one card, every empty central stack doubles what can be moved
+		size_t emptyStacks = m_emptyCentralStacks;
+		if (toEmptyStack && emptyStacks > 0)
+			--emptyStacks;
+		return (m_emptyFreeCells + 1) << emptyStacks;
+	}
+
+	bool FreeCellGame::canMoveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex) const
+	{
+		if (m_state != State::Playing)
+			return false;
+		if (sourceStackIndex >= m_stacks.size() || destStackIndex >= m_stacks.size() || sourceStackIndex == destStackIndex)
+			return false;
+
+		// cards never leave the end stacks
+		if (isEndStack(sourceStackIndex))
+			return false;
+
+		const CardStack& source = m_stacks[sourceStackIndex];
+		if (sourceCardIndex >= source.size() || !isRun(source, sourceCardIndex))
+			return false;
+
+		return fits(source.cards()[sourceCardIndex], source.size() - sourceCardIndex, destStackIndex);
+	}
+
+	bool FreeCellGame::moveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex)
+	{
+		PANDA_PROFILE_SCOPE("FreeCellGame::moveCards");
+		if (!canMoveCards(sourceStackIndex, sourceCardIndex, destStackIndex))
+			return false;
+
+		transfer(sourceStackIndex, sourceCardIndex, destStackIndex);
+		if (m_autoPlay)
+			playSafeCards();
+		return true;
+	}
+
+	std::vector<Move> FreeCellGame::legalMoves() const
+	{
+		std::vector<Move> moves;
+		if (m_state != State::Playing)
+			return moves;
+
+		for (size_t sourceIndex = 0; sourceIndex < m_stacks.size(); ++sourceIndex)
+		{
+			const CardStack& source = m_stacks[sourceIndex];
+			if (isEndStack(sourceIndex) || source.size() == 0)
+				continue;
+
+			// only the run on top of a central stack can move, found once per stack
+			size_t runStart = source.topIndex();
+			while (runStart > 0 && isRun(source, runStart - 1))
+				--runStart;
+
+			for (size_t cardIndex = runStart; cardIndex < source.size(); ++cardIndex)
+			{
+				for (size_t destIndex = 0; destIndex < m_stacks.size(); ++destIndex)
+				{
+					if (destIndex != sourceIndex && fits(source.cards()[cardIndex], source.size() - cardIndex, destIndex))
+						moves.push_back(Move{Move::Type::Cards, sourceIndex, cardIndex, destIndex});
+				}
+			}
+		}
+		return moves;
+	}
+
+	bool FreeCellGame::applyMove(const Move& move)
+	{
+		if (move.type != Move::Type::Cards)
+			return false;    // nothing to draw or flip, every card is open
+		return moveCards(move.sourceStack, move.sourceCard, move.destStack);
+	}
+
+	size_t FreeCellGame::hash() const
+	{
+		uint64_t h = 14695981039346656037ull;
+
+		// free cells and central stacks are hashed as sorted sets, their order does not change the game
+		std::array<uint64_t, 4> cells;
+		for (size_t i = 0; i < cells.size(); ++i)
+			cells[i] = m_stacks[i].size() == 0 ? 0 : cardCode(m_stacks[i].cards().back()) + 1;
+		std::sort(cells.begin(), cells.end());
+		for (uint64_t cell : cells)
+			h = mix(h, cell);
+
+		for (int height : m_endHeights)
+			h = mix(h, static_cast<uint64_t>(height));
+
+		std::array<uint64_t, 8> central;
+		for (size_t i = 0; i < central.size(); ++i)
+		{
+			uint64_t stackHash = 14695981039346656037ull;
+			for (const Card& card : m_stacks[8 + i].cards())
+				stackHash = mix(stackHash, cardCode(card));
+			central[i] = stackHash;
+		}
+		std::sort(central.begin(), central.end());
+		for (uint64_t stackHash : central)
+			h = mix(h, stackHash);
+
+		return static_cast<size_t>(h);
+	}
+
+	void FreeCellGame::setAutoPlay(bool enabled)
+	{
+		m_autoPlay = enabled;
+		if (m_autoPlay)
+			playSafeCards();
+	}
+
+	bool FreeCellGame::isRun(const CardStack& stack, size_t firstCardIndex) const
+	{
+		const std::pmr::vector<Card>& cards = stack.cards();
+		for (size_t i = firstCardIndex + 1; i < cards.size(); ++i)
+		{
+			if (cards[i - 1].number != cards[i].number + 1 || cards[i - 1].isSameColor(cards[i]))
+				return false;
+		}
+		return true;
+	}
+
+	bool FreeCellGame::fits(const Card& card, size_t count, size_t destStackIndex) const
+	{
+		const CardStack& dest = m_stacks[destStackIndex];
+
+		if (isFreeCell(destStackIndex))
+			return count == 1 && dest.size() == 0;
+
+		if (isEndStack(destStackIndex))
+		{
+			if (count != 1)
+				return false;
+			std::optional<Card> top = dest.top();
+			return top ? top->suit == card.suit && top->number + 1 == card.number : card.number == 1;
+		}
+
+		// central stacks take runs as long as the free cells and empty stacks allow
+		if (count > maxMovableCards(dest.size() == 0))
+			return false;
+		std::optional<Card> top = dest.top();
+		return !top || (top->number == card.number + 1 && !top->isSameColor(card));
+	}
+
+	void FreeCellGame::transfer(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex)
+	{
+		CardStack& source = m_stacks[sourceStackIndex];
+		CardStack& dest = m_stacks[destStackIndex];
+		bool destWasEmpty = dest.size() == 0;
+
+		MoveBuffer buffer;
+		std::optional<CardStack> toMove = source.take(sourceCardIndex, &buffer);
+		const Card& bottom = toMove->cards().front();
+		if (isEndStack(destStackIndex))
+			m_endHeights[static_cast<size_t>(bottom.suit)] = bottom.number;
+		dest.append(std::move(*toMove));
+
+		if (source.size() == 0)
+			isFreeCell(sourceStackIndex) ? ++m_emptyFreeCells : ++m_emptyCentralStacks;
+		if (destWasEmpty && !isEndStack(destStackIndex))
+			isFreeCell(destStackIndex) ? --m_emptyFreeCells : --m_emptyCentralStacks;
+
+		if (std::all_of(m_endHeights.begin(), m_endHeights.end(), [](int height) { return height == 13; }))
+			m_state = State::Win;
+	}
+
+	std::optional<size_t> FreeCellGame::endStackFor(const Card& card) const
+	{
+		if (m_endHeights[static_cast<size_t>(card.suit)] != card.number - 1)
+			return std::nullopt;
+
+		for (size_t endIndex = 4; endIndex < 8; ++endIndex)
+		{
+			std::optional<Card> top = m_stacks[endIndex].top();
+			if (card.number == 1 ? !top : top && top->suit == card.suit)
+				return endIndex;
+		}
+		return std::nullopt;
+	}
+
+	void FreeCellGame::playSafeCards()
+	{
+		// a card is safe once both cards of the other color one number lower are in the end stacks
+		auto isSafe = [this](const Card& card) {
+			if (card.number <= 2)
+				return true;
+			bool red = card.suit == Card::Suit::Heart || card.suit == Card::Suit::Diamond;
+			size_t opposite = red ? static_cast<size_t>(Card::Suit::Club) : static_cast<size_t>(Card::Suit::Heart);
+			return m_endHeights[opposite] >= card.number - 1 && m_endHeights[opposite + 1] >= card.number - 1;
+		};
+
+		bool moved = true;
+		while (moved && m_state == State::Playing)
+		{
+			moved = false;
+			for (size_t sourceIndex = 0; sourceIndex < m_stacks.size(); ++sourceIndex)
+			{
+				if (isEndStack(sourceIndex))
+					continue;
+
+				const CardStack& source = m_stacks[sourceIndex];
+				while (source.size() != 0)
+				{
+					const Card& card = source.cards().back();
+					std::optional<size_t> destIndex = isSafe(card) ? endStackFor(card) : std::nullopt;
+					if (!destIndex)
+						break;
+					transfer(sourceIndex, source.topIndex(), *destIndex);
+					moved = true;
+				}
+			}
+		}
+	}
+
+	void FreeCellGame::countStacks()
+	{
+		m_emptyFreeCells = 0;
+		m_emptyCentralStacks = 0;
+		m_endHeights = {};
+		for (size_t stackIndex = 0; stackIndex < m_stacks.size(); ++stackIndex)
+		{
+			const CardStack& stack = m_stacks[stackIndex];
+			if (isEndStack(stackIndex))
+			{
+				if (std::optional<Card> top = stack.top())
+					m_endHeights[static_cast<size_t>(top->suit)] = top->number;
+			}
+			else if (stack.size() == 0)
+			{
+				isFreeCell(stackIndex) ? ++m_emptyFreeCells : ++m_emptyCentralStacks;
+			}
+		}
+
+		if (std::all_of(m_endHeights.begin(), m_endHeights.end(), [](int height) { return height == 13; }))
+			m_state = State::Win;
+	}
+}
@@ -0,0 +1,234 @@
+#include "FreeCellSolver.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <queue>
+
+namespace panda
+{
+	namespace
+	{
+		// Rates how close the game is to being won, higher is better
+		int evaluate(const FreeCellGame& game)
+		{
+			int score = 0;
+			for (Card::Suit suit : {Card::Suit::Heart, Card::Suit::Diamond, Card::Suit::Club, Card::Suit::Spade})
+				score += 20 * game.endHeight(suit);
+
+			for (size_t stackIndex = 0; stackIndex < FreeCellGame::stackCount; ++stackIndex)
+			{
+				const std::pmr::vector<Card>& cards = game.stacks()[stackIndex].cards();
+				if (FreeCellGame::isEndStack(stackIndex))
+					continue;
+				if (cards.empty())
+				{
+					score += FreeCellGame::isFreeCell(stackIndex) ? 6 : 12;
+					continue;
+				}
+
+				// a card above a lower card has to move again before the lower card can go to the end stacks
+				int lowest = 14;
+				for (size_t i = 0; i < cards.size(); ++i)
+				{
+					const Card& card = cards[i];
+					if (card.number > lowest)
+						score -= 3;
+					lowest = std::min(lowest, card.number);
+
+					// cards burying the next card of a suit cost the most
+					if (card.number == game.endHeight(card.suit) + 1)
+						score -= 4 * static_cast<int>(cards.size() - 1 - i);
+				}
+			}
+			return score;
+		}
+	}
+
+	FreeCellSolver::FreeCellSolver()
+		: FreeCellSolver(Limits{})
+	{
+	}
+
+	FreeCellSolver::FreeCellSolver(Limits limits)
+		: m_limits(limits)
+	{
+	}
+
+	FreeCellSolver::Solution FreeCellSolver::solve(const FreeCellGame& game)
+	{
+		m_visited.clear();
+		m_nodes = 0;
+		m_limitReached = false;
+		m_deadline = std::chrono::steady_clock::now() + m_limits.maxTime;
+
+		FreeCellGame start = game;
+		start.setAutoPlay(true);
+
+		Solution solution;
+		bool solved = search(start, solution.moves);
+		solution.nodes = m_nodes;
+		if (solved)
+			solution.result = Result::Solved;
+		else
+			solution.result = m_limitReached ? Result::LimitReached : Result::Unsolvable;
+
+		if (!solved)
+			solution.moves.clear();
+		return solution;
+	}
+
+	std::vector<Move> FreeCellSolver::candidateMoves(const FreeCellGame& game)
+	{
+		std::vector<Move> toEnd;
+		std::vector<Move> fromCell;
+		std::vector<Move> building;
+		std::vector<Move> splitting;
+		std::vector<Move> toCell;
+		std::vector<Move> toEmpty;
+
+		// the free cells and the empty central stacks are interchangeable, only the first one of each is tried
+		size_t firstEmptyCell = FreeCellGame::stackCount;
+		size_t firstEmptyCentral = FreeCellGame::stackCount;
+		for (size_t stackIndex = 0; stackIndex < FreeCellGame::stackCount; ++stackIndex)
+		{
+			if (game.stacks()[stackIndex].size() != 0 || FreeCellGame::isEndStack(stackIndex))
+				continue;
+			if (FreeCellGame::isFreeCell(stackIndex) && firstEmptyCell == FreeCellGame::stackCount)
+				firstEmptyCell = stackIndex;
+			else if (FreeCellGame::isCentralStack(stackIndex) && firstEmptyCentral == FreeCellGame::stackCount)
+				firstEmptyCentral = stackIndex;
+		}
+
+		for (const Move& move : game.legalMoves())
+		{
+			const CardStack& source = game.stacks()[move.sourceStack];
+			const CardStack& dest = game.stacks()[move.destStack];
+			bool fromFreeCell = FreeCellGame::isFreeCell(move.sourceStack);
+
+			if (FreeCellGame::isEndStack(move.destStack))
+				toEnd.push_back(move);
+			else if (FreeCellGame::isFreeCell(move.destStack))
+			{
+				if (!fromFreeCell && move.destStack == firstEmptyCell)
+					toCell.push_back(move);
+			}
+			else if (dest.size() == 0)
+			{
+				// moving a whole stack to an empty one changes nothing
+				if (move.destStack == firstEmptyCentral && (fromFreeCell || move.sourceCard > 0))
+					toEmpty.push_back(move);
+			}
+			else if (fromFreeCell)
+				fromCell.push_back(move);
+			else if (move.sourceCard == 0)
+				building.insert(building.begin(), move);    // empties the source stack
+			else
+			{
+				// moving the whole run uncovers a new card, moving part of it rarely helps
+				const Card& below = source.cards()[move.sourceCard - 1];
+				const Card& moved = source.cards()[move.sourceCard];
+				bool wholeRun = below.number != moved.number + 1 || below.isSameColor(moved);
+				(wholeRun ? building : splitting).push_back(move);
+			}
+		}
+
+		std::vector<Move> moves;
+		moves.reserve(toEnd.size() + fromCell.size() + building.size() + splitting.size() + toCell.size() + toEmpty.size());
+		for (auto* group : {&toEnd, &fromCell, &building, &toCell, &toEmpty, &splitting})
+			moves.insert(moves.end(), group->begin(), group->end());
+		return moves;
+	}
+
+	bool FreeCellSolver::search(const FreeCellGame& game, std::vector<Move>& path)
+	{
+		// best first: the open state with the highest score is expanded next, states are stored packed
+		struct Node
+		{
+			std::array<uint8_t, 68> cards;    // every stack in order, each followed by a separator
+			uint32_t parent;
+			uint8_t sourceStack;
+			uint8_t sourceCard;
+			uint8_t destStack;
+		};
+		auto pack = [](const FreeCellGame& state) {
+			std::array<uint8_t, 68> packed{};
+			size_t i = 0;
+			for (const CardStack& stack : state.stacks())
+			{
+				for (const Card& card : stack.cards())
+					packed[i++] = static_cast<uint8_t>(card.number | static_cast<int>(card.suit) << 4);
+				packed[i++] = 0xFF;
+			}
+			return packed;
+		};
+		auto unpack = [](const std::array<uint8_t, 68>& packed) {
+			std::vector<CardStack> stacks;
+			stacks.reserve(FreeCellGame::stackCount);
+			std::pmr::vector<Card> cards;
+			for (uint8_t code : packed)
+			{
+				if (code == 0xFF)
+				{
+					stacks.emplace_back(std::move(cards));
+					cards.clear();
+				}
+				else
+					cards.emplace_back(code & 0xF, static_cast<Card::Suit>(code >> 4));
+			}
+			FreeCellGame state(std::move(stacks));
+			state.setAutoPlay(true);
+			return state;
+		};
+
+		std::vector<Node> nodes;
+		std::priority_queue<std::pair<int, size_t>> open;
+		nodes.push_back(Node{pack(game), 0, 0, 0, 0});
+		open.emplace(evaluate(game), 0);
+		m_visited.insert(game.hash());
+		if (game.state() == FreeCellGame::State::Win)
+			return true;
+
+		while (!open.empty())
+		{
+			if (limitReached())
+				return false;
+			++m_nodes;
+
+			size_t index = open.top().second;
+			open.pop();
+			FreeCellGame state = unpack(nodes[index].cards);
+
+			for (const Move& move : candidateMoves(state))
+			{
+				FreeCellGame next = state;
+				if (!next.applyMove(move) || !m_visited.insert(next.hash()).second)
+					continue;
+
+				nodes.push_back(Node{pack(next), static_cast<uint32_t>(index), static_cast<uint8_t>(move.sourceStack),
+					static_cast<uint8_t>(move.sourceCard), static_cast<uint8_t>(move.destStack)});
+				if (next.state() == FreeCellGame::State::Win)
+				{
+					for (size_t i = nodes.size() - 1; i != 0; i = nodes[i].parent)
+						path.push_back(Move{Move::Type::Cards, nodes[i].sourceStack, nodes[i].sourceCard, nodes[i].destStack});
+					std::reverse(path.begin(), path.end());
+					return true;
+				}
+				open.emplace(evaluate(next), nodes.size() - 1);
+			}
+		}
+		return false;
+	}
+
+	bool FreeCellSolver::limitReached()
+	{
+		if (m_nodes >= m_limits.maxNodes)
+			m_limitReached = true;
+		else if (m_limits.cancelled && m_limits.cancelled->load(std::memory_order_relaxed))
+			m_limitReached = true;
+		// reading the clock is comparatively slow, only check it every few nodes
+		else if ((m_nodes & 0x3FF) == 0 && std::chrono::steady_clock::now() > m_deadline)
+			m_limitReached = true;
+		return m_limitReached;
+	}
+}
@@ -1,15 +1,19 @@
 #include "Game.h"
 
+#include "Profiler.h"
+
+#include <algorithm>
 #include <assert.h>
+#include <cstdint>
 #include <random>
 
 namespace panda
 {
 	namespace
 	{
-		std::vector<Card> createDeck()
+		std::pmr::vector<Card> createDeck()
 		{
-			std::vector<Card> deck(52);
+			std::pmr::vector<Card> deck(52);
 			for (size_t suitIndex = 0; suitIndex < 4; ++suitIndex)
 			{
 				for (size_t numberIndex = 0; numberIndex < 13; ++numberIndex)
@@ -24,25 +28,69 @@ namespace panda
 			}
 			return deck;
 		}
+
+		// Fisher-Yates shuffle driven directly by the engine output
+		// std::shuffle is implementation defined, this keeps seeded deals identical on every platform
+		void shuffleDeck(std::pmr::vector<Card>& deck, std::mt19937& g)
+		{
+			for (size_t i = deck.size() - 1; i > 0; --i)
+			{
+				size_t j = static_cast<size_t>(g() % (i + 1));
+				std::swap(deck[i], deck[j]);
+			}
+		}
 	}
 
-	Game::Game(Stacks&& stacks)
+	template <class Rules>
+	BasicGame<Rules>::BasicGame(Stacks&& stacks)
+		: m_stock(stacks.closedStack, stacks.openStack)
 	{
+		m_stock.setDrawCount(Rules::drawCount);
 		m_stacks.insert(m_stacks.end(), std::move(stacks.closedStack));
 		m_stacks.insert(m_stacks.end(), std::move(stacks.openStack));
 		m_stacks.insert(m_stacks.end(), std::make_move_iterator(stacks.endStack.begin()), std::make_move_iterator(stacks.endStack.end()));
 		m_stacks.insert(m_stacks.end(), std::make_move_iterator(stacks.centralStack.begin()), std::make_move_iterator(stacks.centralStack.end()));
+
+		for (size_t stackIndex : centralStacksIndices())
+			m_closedCentralCards += closedCards(m_stacks[stackIndex], 0);
+
+		for (size_t stackIndex : endStacksIndices())
+		{
+			std::optional<Card> top = m_stacks[stackIndex].top();
+			if (top)
+				m_endHeights[static_cast<size_t>(top->suit)] = top->number;
+		}
+
+		for (size_t stackIndex = 2; stackIndex < m_stacks.size(); ++stackIndex)
+			placeCards(stackIndex, 0);
+		placeStockCards(0, m_stock.size());
 	}
 
-	Game Game::createRandomGame()
+	template <class Rules>
+	BasicGame<Rules>::BasicGame(const BasicGame& other, std::pmr::memory_resource* resource)
+		: m_stacks(resource)
+		, m_stock(std::pmr::vector<Card>(resource))
+	{
+		// copy assignment keeps the resource of the containers, as later assignments do
+		*this = other;
+	}
+
+	template <class Rules>
+	BasicGame<Rules> BasicGame<Rules>::createRandomGame()
+	{
+		std::random_device rd;
+		return createRandomGame(rd());
+	}
+
+	template <class Rules>
+	BasicGame<Rules> BasicGame<Rules>::createRandomGame(unsigned int seed)
 	{
 		// start with a deck
 		auto deck = createDeck();
 
 		// random shuffle
-		std::random_device rd;
-		std::mt19937 g(rd());
-		std::shuffle(deck.begin(), deck.end(), g);
+		std::mt19937 g(seed);
+		shuffleDeck(deck, g);
 
 		// separate cards into stacks
 
@@ -56,7 +104,7 @@ namespace panda
 		for (size_t i = 0; i < centralStack.size(); ++i)
 		{
 			size_t cardsToTake = i + 2;
-			std::vector<Card> cards;
+			std::pmr::vector<Card> cards;
 			auto cardIt = deck.end() - cardsToTake;
 			// move cards into separate vector
 			cards.insert(cards.end(), std::make_move_iterator(cardIt), std::make_move_iterator(deck.end()));
@@ -72,14 +120,15 @@ namespace panda
 
 		CardStack closedStack(std::move(deck));    // closed stack are the left over cards
 
-		CardStack openStack{std::vector<Card>{}};
-		Game::Stacks state(std::move(endStack), std::move(centralStack), std::move(closedStack), std::move(openStack));
+		CardStack openStack;
+		Stacks state(std::move(endStack), std::move(centralStack), std::move(closedStack), std::move(openStack));
 
 		// create a fixed state for now
-		return Game(std::move(state));
+		return BasicGame(std::move(state));
 	}
 
-	Game Game::createNearEndingGame()
+	template <class Rules>
+	BasicGame<Rules> BasicGame<Rules>::createNearEndingGame()
 	{
 		// start with a deck
 		auto deck = createDeck();
@@ -92,7 +141,7 @@ namespace panda
 			std::advance(cardBegin, suitIndex * 13);
 			auto cardEnd = cardBegin;
 			std::advance(cardEnd, 13);
-			std::vector<Card> cards(cardBegin, cardEnd);
+			std::pmr::vector<Card> cards(cardBegin, cardEnd);
 			endStack[suitIndex] = CardStack(std::move(cards));
 			endStack[suitIndex].flipAll();
 		}
@@ -101,44 +150,70 @@ namespace panda
 		std::array<CardStack, 7> centralStack;
 		CardStack closedStack;    // closed stack are the left over cards
 		CardStack openStack;
-		Game::Stacks state(std::move(endStack), std::move(centralStack), std::move(closedStack), std::move(openStack));
+		Stacks state(std::move(endStack), std::move(centralStack), std::move(closedStack), std::move(openStack));
 
 		// create a fixed state for now
-		return Game(std::move(state));
+		return BasicGame(std::move(state));
 	}
 
-	void Game::openCard()
+	template <class Rules>
+	void BasicGame<Rules>::openCard()
 	{
-		std::optional<CardStack> top = closedStack().takeTop();
-		if (top)
+		size_t opened = m_stock.openSize();
+		if (m_stock.draw())
 		{
-			top->flipAll();
-			openStack().append(std::move(*top));
+			stockChanged();
+			placeStockCards(opened, m_stock.openSize());
+
+			// every card the cycle shows is checked once, while the tableau stays as it is the answer holds for the whole cycle
+			std::optional<Card> top = m_stock.top();
+			if (top && !m_stockPlayable)
+			{
+				m_stockPlayable = endStackFor(*top).has_value();
+				for (size_t centralIndex : centralStacksIndices())
+					m_stockPlayable = m_stockPlayable || canMoveToCentralStack(*top, m_stacks[centralIndex]);
+			}
 		}
 		else
 		{
 			resetClosedStack();
 		}
+
+		if (m_autoPlay)
+		{
+			playSafeCards();
+			checkWin();
+		}
+		checkLose();
 	}
 
-	void Game::resetClosedStack()
+	template <class Rules>
+	void BasicGame<Rules>::resetClosedStack()
 	{
-		assert(closedStack().size() == 0);
-		if (closedStack().size() != 0)
-			return;
+		assert(m_stock.closedSize() == 0);
 
-		if (openStack().size() == 0)
+		if (!canRecycle())
 			return;
 
-		// swap open and closed stack
-		std::swap(openStack(), closedStack());
-		// invert stack
-		closedStack().invertOrder();
-		// flip stack
-		closedStack().flipAll();
+		// the open cards are drawn in the same order again, only the split of the stock moves
+		if (m_stock.recycle())
+		{
+			stockChanged();
+			placeStockCards(0, m_stock.size());
+			if constexpr (Rules::recycleLimit != unlimitedRecycles)
+				++m_recycles;
+			endCycle();
+		}
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::canDraw() const
+	{
+		return m_stock.closedSize() != 0 || (m_stock.openSize() != 0 && canRecycle());
 	}
 
-	bool Game::moveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex)
+	template <class Rules>
+	bool BasicGame<Rules>::canMoveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex) const
 	{
 		// check stack indices are inside bounds
 		if (sourceStackIndex >= m_stacks.size() || sourceStackIndex < 0)
@@ -150,48 +225,209 @@ namespace panda
 		if (sourceStackIndex == destStackIndex)
 			return false;
 
-		CardStack& destStack = m_stacks[destStackIndex];
-		CardStack& sourceStack = m_stacks[sourceStackIndex];
-
-		// check card index is inside bounds
-		if (sourceCardIndex >= sourceStack.size() || sourceCardIndex < 0)
+		// closed cards can only be drawn
+		if (isClosedStack(sourceStackIndex))
 			return false;
 
-		// check rules to move between stacks
-		if (isCentralStack(destStackIndex))
+		const CardStack& destStack = m_stacks[destStackIndex];
+
+		// only the top open card can leave the stock
+		std::optional<Card> sourceCard;
+		bool isTop = true;
+		if (isOpenStack(sourceStackIndex))
 		{
-			if (!canMoveToCentralStack(sourceStack, sourceCardIndex, destStack))
+			if (sourceCardIndex + 1 != m_stock.openSize())
 				return false;
+			sourceCard = m_stock.top();
 		}
-		else if (isEndStack(destStackIndex))
+		else
 		{
-			if (!canMoveToEndStack(sourceStack, sourceCardIndex, destStack))
+			const CardStack& sourceStack = m_stacks[sourceStackIndex];
+
+			// check card index is inside bounds
+			if (sourceCardIndex >= sourceStack.size() || sourceCardIndex < 0)
 				return false;
+			sourceCard = sourceStack.cards()[sourceCardIndex];
+			isTop = sourceCardIndex == sourceStack.topIndex();
 		}
-		else
-		{
-			// can't apply move operations on any other destination stacks
+
+		// check rules to move between stacks
+		if (isCentralStack(destStackIndex))
+			return canMoveToCentralStack(*sourceCard, destStack);
+		if (isEndStack(destStackIndex))
+			return canMoveToEndStack(*sourceCard, isTop, destStack);
+
+		// can't apply move operations on any other destination stacks
+		return false;
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::moveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex)
+	{
+		PANDA_PROFILE_SCOPE("Game::moveCards");
+		if (!canMoveCards(sourceStackIndex, sourceCardIndex, destStackIndex))
 			return false;
-		}
+
+		CardStack& destStack = m_stacks[destStackIndex];
+
+		MoveBuffer buffer;
 
 		// take from source stack and move to dest stack
-		std::optional<CardStack> toMove = sourceStack.take(sourceCardIndex);
+		std::optional<CardStack> toMove;
+		if (isOpenStack(sourceStackIndex))
+		{
+			toMove = CardStack(std::pmr::vector<Card>({*m_stock.takeTop()}, &buffer));
+			stockChanged();
+		}
+		else
+		{
+			toMove = m_stacks[sourceStackIndex].take(sourceCardIndex, &buffer);
+		}
 		if (!toMove)
 			return false;
 
+		PANDA_PROFILE_COUNTER("cards moved", toMove->size());
+		size_t closedMoved = closedCards(*toMove, 0);
+		if (isCentralStack(sourceStackIndex))
+			m_closedCentralCards -= closedMoved;
+		if (isCentralStack(destStackIndex))
+			m_closedCentralCards += closedMoved;
+
+		// only single cards go in and out of end stacks, the moved card sets the height of its suit
+		// an ace moved between end stacks leaves the height as it was
+		const Card& bottom = toMove->cards().front();
+		if (isEndStack(sourceStackIndex))
+			m_endHeights[static_cast<size_t>(bottom.suit)] = bottom.number - 1;
+		if (isEndStack(destStackIndex))
+			m_endHeights[static_cast<size_t>(bottom.suit)] = bottom.number;
+
+		size_t firstMoved = destStack.size();
 		bool ok = destStack.append(std::move(*toMove));
+		placeCards(destStackIndex, firstMoved);
+
+		positionChanged();
+		if (m_autoPlay)
+			playSafeCards();
 
 		// check it the user has won
 		checkWin();
+		checkLose();
 
 		return ok;
 	}
 
-	bool Game::isFlippedCard(size_t stack, size_t cardIndex)
+	template <class Rules>
+	std::vector<Move> BasicGame<Rules>::legalMoves() const
+	{
+		std::vector<Move> moves;
+		legalMoves(moves);
+		return moves;
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::legalMoves(std::vector<Move>& moves) const
+	{
+		moves.clear();
+
+		// drawing is possible while there are closed cards, or open cards that can be turned over
+		if (canDraw())
+			moves.push_back(Move{Move::Type::Draw});
+
+		for (size_t sourceIndex = 0; sourceIndex < m_stacks.size(); ++sourceIndex)
+		{
+			if (isClosedStack(sourceIndex))
+				continue;
+
+			// the top open card is the only card of the stock that can move
+			if (isOpenStack(sourceIndex))
+			{
+				if (m_stock.openSize() == 0)
+					continue;
+				addCardMoves(moves, sourceIndex, m_stock.openSize() - 1, *m_stock.top(), true);
+				continue;
+			}
+
+			const CardStack& source = m_stacks[sourceIndex];
+			if (source.size() == 0)
+				continue;
+
+			// closed central cards have to be flipped before they can be moved
+			if (isCentralStack(sourceIndex) && source.cards().back().state == Card::State::Closed)
+			{
+				moves.push_back(Move{Move::Type::Flip, sourceIndex, source.topIndex()});
+				continue;
+			}
+
+			// only central stacks can move more than their top card
+			size_t firstCard = source.topIndex();
+			if (isCentralStack(sourceIndex))
+			{
+				std::optional<size_t> firstOpen = source.firstOpenCard();
+				if (!firstOpen)
+					continue;
+				firstCard = *firstOpen;
+			}
+
+			for (size_t cardIndex = firstCard; cardIndex < source.size(); ++cardIndex)
+				addCardMoves(moves, sourceIndex, cardIndex, source.cards()[cardIndex], cardIndex == source.topIndex());
+		}
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::applyMove(const Move& move)
+	{
+		switch (move.type)
+		{
+		case Move::Type::Draw:
+			if (!canDraw())
+				return false;
+			openCard();
+			return true;
+		case Move::Type::Flip:
+			if (!isFlippedCard(move.sourceStack, move.sourceCard))
+				return false;
+			return flipCard(move.sourceStack, move.sourceCard);
+		case Move::Type::Cards:
+			return moveCards(move.sourceStack, move.sourceCard, move.destStack);
+		}
+		return false;
+	}
+
+	template <class Rules>
+	size_t BasicGame<Rules>::hash() const
+	{
+		// FNV-1a over every card, with a separator per stack
+		uint64_t h = 14695981039346656037ull;
+		auto add = [&h](uint64_t value) {
+			h ^= value;
+			h *= 1099511628211ull;
+		};
+
+		// card states in the stock buffer are implied by the split
+		for (const Card& card : m_stock.cards())
+			add(static_cast<uint64_t>(card.number) | static_cast<uint64_t>(card.suit) << 4);
+		add(0xFF | static_cast<uint64_t>(m_stock.openSize()) << 8 | static_cast<uint64_t>(m_stock.drawCount()) << 16 |
+			static_cast<uint64_t>(m_recycles) << 24);
+
+		for (size_t stackIndex = 2; stackIndex < m_stacks.size(); ++stackIndex)
+		{
+			for (const Card& card : m_stacks[stackIndex].cards())
+				add(static_cast<uint64_t>(card.number) | static_cast<uint64_t>(card.suit) << 4 | static_cast<uint64_t>(card.state) << 6);
+			add(0xFF);
+		}
+		return static_cast<size_t>(h);
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::isFlippedCard(size_t stack, size_t cardIndex)
 	{
 		if (stack >= m_stacks.size() || stack < 0)
 			return false;
 
+		// the stock keeps its own card states
+		if (isClosedStack(stack) || isOpenStack(stack))
+			return false;
+
 		CardStack& sourceStack = m_stacks[stack];
 		if (cardIndex >= sourceStack.size() || cardIndex < 0)
 			return false;
@@ -200,11 +436,16 @@ namespace panda
 		return card.state == Card::State::Closed;
 	}
 
-	bool Game::flipCard(size_t stack, size_t cardIndex)
+	template <class Rules>
+	bool BasicGame<Rules>::flipCard(size_t stack, size_t cardIndex)
 	{
 		if (stack >= m_stacks.size() || stack < 0)
 			return false;
 
+		// cards in the stock are opened by drawing
+		if (isClosedStack(stack) || isOpenStack(stack))
+			return false;
+
 		CardStack& sourceStack = m_stacks[stack];
 		if (cardIndex >= sourceStack.size() || cardIndex < 0)
 			return false;
@@ -214,28 +455,52 @@ namespace panda
 		if (cardIndex != stackTopIndex)
 			return false;
 
+		if (isCentralStack(stack))
+		{
+			if (sourceStack.cards().back().state == Card::State::Closed)
+				m_closedCentralCards--;
+			else
+				m_closedCentralCards++;
+		}
+
 		sourceStack.flipTop();
+		positionChanged();
+
+		if (m_autoPlay)
+		{
+			playSafeCards();
+			checkWin();
+		}
+		checkLose();
 		return true;
 	}
 
-	bool Game::isEndStack(size_t index) const { return index >= 2 && index < 6; }
-
-	bool Game::isCentralStack(size_t index) const { return index >= 6 && index < 13; }
-
-	bool Game::isOpenStack(size_t index) const { return index == 1; }
-
-	bool Game::isClosedStack(size_t index) const { return index == 0; }
-
-	CardStack& Game::openStack() { return m_stacks[1]; }
-
-	CardStack& Game::closedStack() { return m_stacks[0]; };
-
-	std::array<size_t, 7> Game::centralStacksIndices() const { return {6, 7, 8, 9, 10, 11, 12}; }
+	template <class Rules>
+	const std::pmr::vector<CardStack>& BasicGame<Rules>::stacks() const
+	{
+		if (!m_stockStacksValid)
+		{
+			m_stock.toStacks(m_stacks[0], m_stacks[1]);
+			m_stockStacksValid = true;
+		}
+		return m_stacks;
+	}
 
-	std::array<size_t, 4> Game::endStacksIndices() const { return {2, 3, 4, 5}; }
+	template <class Rules>
+	const CardStack& BasicGame<Rules>::stack(size_t index) const
+	{
+		if (isClosedStack(index) || isOpenStack(index))
+			return stacks()[index];
+		return m_stacks[index];
+	}
 
-	void Game::checkWin()
+	template <class Rules>
+	void BasicGame<Rules>::checkWin()
 	{
+		// every suit has to be complete before the order of the end stacks is worth checking
+		if (std::any_of(m_endHeights.begin(), m_endHeights.end(), [](int height) { return height != 13; }))
+			return;
+
 		bool stacksComplete = true;
 		for (auto stackIndex : endStacksIndices())
 		{
@@ -262,46 +527,514 @@ namespace panda
 			m_state = State::Win;
 	}
 
-	bool Game::canMoveToCentralStack(CardStack& sourceStack, size_t sourceCardIndex, CardStack& destStack)
+	template <class Rules>
+	void BasicGame<Rules>::checkLose()
 	{
-		// Card to be moved in
-		const Card& sourceCard = sourceStack.cards()[sourceCardIndex];
+		// while the stock can be drawn the cycle check decides, see endCycle
+		if (m_state != State::Playing || canDraw() || hasProductiveMove())
+			return;
+		m_state = State::Lose;
+	}
 
-		std::optional<Card> destTop = destStack.top();
-		if (destTop)
+	template <class Rules>
+	bool BasicGame<Rules>::hasProductiveMove() const
+	{
+		std::vector<Move> moves;
+		legalMoves(moves);
+		for (const Move& move : moves)
 		{
-			// if dest central stack has cards, source has to be compatible
-			return !sourceCard.isSameColor(*destTop) && sourceCard.isLower(*destTop) && sourceCard.isAdjacent(*destTop);
+			if (move.type == Move::Type::Flip)
+				return true;
+			if (move.type != Move::Type::Cards)
+				continue;
+
+			// playing the stock or to the end stacks moves the game forward, an ace between end stacks does not
+			if (isOpenStack(move.sourceStack))
+				return true;
+			if (isEndStack(move.destStack))
+			{
+				if (!isEndStack(move.sourceStack))
+					return true;
+				continue;
+			}
+
+			// a card back from the end stacks can start chains of moves through the tableau that are not followed here
+			if (isEndStack(move.sourceStack))
+				return true;
+
+			// a whole run uncovers a closed card, or empties the stack for a card that can start one
+			// a run that could start the stack itself only changes columns by moving
+			const CardStack& source = m_stacks[move.sourceStack];
+			std::optional<size_t> firstOpen = source.firstOpenCard();
+			if (firstOpen && move.sourceCard == *firstOpen)
+			{
+				if (move.sourceCard > 0)
+					return true;
+				if (!Rules::canStartColumn(source.cards().front()) && m_stacks[move.destStack].size() != 0 && hasWaitingColumnStart())
+					return true;
+				continue;
+			}
+
+			// part of a run uncovers an open card, which only helps when it can go somewhere or take a waiting card
+			const Card& uncovered = source.cards()[move.sourceCard - 1];
+			if (endStackFor(uncovered) || canUseParent(uncovered))
+				return true;
 		}
+		return false;
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::canUseParent(const Card& parent) const
+	{
+		CardSet parents = cardBit(parent);
+		CardSet takenBack = 0;
 
-		// if the dest central stack is empty, it can be moved in if it's a K
-		if (destStack.size() == 0)
+		// cards taken back from the end stacks land on the open tops of the central stacks, or kings on empty stacks
+		CardSet tops = 0;
+		size_t emptyColumns = 0;
+		for (size_t centralIndex : centralStacksIndices())
 		{
-			return sourceCard.number == 13;
+			const CardStack& stack = m_stacks[centralIndex];
+			if (stack.size() == 0)
+				++emptyColumns;
+			else if (stack.cards().back().state == Card::State::Open)
+				tops |= cardBit(stack.cards().back());
 		}
 
-		return true;
+		// take-back chains are followed until no new parent turns up, every pass takes back at least one of the 52 cards
+		bool changed = true;
+		while (changed)
+		{
+			changed = false;
+			for (size_t id = 0; id < cardCount; ++id)
+			{
+				CardSet bit = CardSet(1) << id;
+				const PackedLocation& location = m_locations[id];
+				if ((takenBack & bit) != 0 || location.stack == noStack)
+					continue;
+
+				Card card = cardFromId(id);
+				CardSet cardParents = centralParents(card);
+				bool fits = (cardParents & parents) != 0;
+				if (isClosedStack(location.stack) || isOpenStack(location.stack))
+				{
+					if (fits)
+						return true;
+					continue;
+				}
+
+				// the bottom open card of a column uncovers a closed card when it moves, or empties the column for a waiting card that can start one
+				const CardStack& stack = m_stacks[location.stack];
+				if (isCentralStack(location.stack))
+				{
+					if (!fits || stack.cards()[location.index].state == Card::State::Closed)
+						continue;
+					if (location.index > 0 && stack.cards()[location.index - 1].state == Card::State::Closed)
+						return true;
+					if (location.index == 0 && !Rules::canStartColumn(card) && hasWaitingColumnStart())
+						return true;
+					continue;
+				}
+
+				// an end card can leave once the cards above it left, and then becomes a parent itself
+				bool exposed = true;
+				for (size_t index = location.index + 1; index < stack.size(); ++index)
+					exposed = exposed && (takenBack & cardBit(stack.cards()[index])) != 0;
+				if (!exposed)
+					continue;
+				bool onTop = fits || (cardParents & tops) != 0;
+				bool onEmpty = !onTop && emptyColumns != 0 && Rules::canStartColumn(card);
+				if (onTop || onEmpty)
+				{
+					emptyColumns -= onEmpty ? 1 : 0;
+					takenBack |= bit;
+					parents |= bit;
+					changed = true;
+				}
+			}
+		}
+		return false;
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::hasWaitingColumnStart() const
+	{
+		for (size_t id = 0; id < cardCount; ++id)
+		{
+			Card card = cardFromId(id);
+			if (!Rules::canStartColumn(card))
+				continue;
+
+			const PackedLocation& location = m_locations[id];
+			if (location.stack == noStack)
+				continue;
+			if (isClosedStack(location.stack) || isOpenStack(location.stack))
+				return true;
+
+			// a card on a closed card uncovers it when it moves to the empty stack
+			if (isCentralStack(location.stack) && location.index > 0 &&
+				m_stacks[location.stack].cards()[location.index - 1].state == Card::State::Closed)
+				return true;
+		}
+		return false;
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::positionChanged()
+	{
+		m_cycleChanged = true;
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::endCycle()
+	{
+		// the cycle is dead when nothing moved, no drawn card fitted, and the position hashes as it did a cycle ago
+		// the hash compare also catches changes made without a move, as by auto play
+		size_t cycleHash = hash();
+		if (m_state == State::Playing && !m_cycleChanged && !m_stockPlayable && cycleHash == m_cycleHash && !hasProductiveMove())
+			m_state = State::Lose;
+
+		m_cycleHash = cycleHash;
+		m_cycleChanged = false;
+		m_stockPlayable = false;
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::canMoveToCentralStack(const Card& sourceCard, const CardStack& destStack) const
+	{
+		std::optional<Card> destTop = destStack.top();
+		if (destTop)
+		{
+			// if dest central stack has cards, source has to be compatible
+			return Rules::canBuildOn(sourceCard, *destTop);
+		}
+
+		// if the dest central stack is empty, the variant decides which cards can start it
+		return Rules::canStartColumn(sourceCard);
 	}
 
-	bool Game::canMoveToEndStack(CardStack& sourceStack, size_t sourceCardIndex, CardStack& destStack)
+	template <class Rules>
+	bool BasicGame<Rules>::canMoveToEndStack(const Card& sourceCard, bool isTop, const CardStack& destStack) const
 	{
 		// has to be the top card in the stack
-		size_t stackTopIndex = std::max(static_cast<size_t>(0), sourceStack.size() - 1);
-		if (sourceCardIndex != stackTopIndex)
+		if (!isTop)
 			return false;
 
-		// Card to be moved in
-		const Card& sourceCard = sourceStack.cards()[sourceCardIndex];
 		std::optional<Card> destTop = destStack.top();
 		if (destTop)
 		{
-			// If end stack has any cards already, source has to be compatible
-			return sourceCard.isSameSuit(*destTop) && sourceCard.isHigher(*destTop) && sourceCard.isAdjacent(*destTop);
+			// If end stack has any cards already, source has to be the next card of the same suit
+			return sourceCard.suit == destTop->suit && sourceCard.number == destTop->number + 1;
 		}
 
 		// If no end stack has no cards, the source card has to be an ace
 		return sourceCard.number == 1;
 	}
 
-	void Game::reset(Game&& other) { *this = other; }
+	template <class Rules>
+	bool BasicGame<Rules>::canAutoComplete() const
+	{
+		return m_state == State::Playing && m_closedCentralCards == 0 && m_stock.size() == 0;
+	}
+
+	template <class Rules>
+	std::vector<Move> BasicGame<Rules>::autoComplete()
+	{
+		std::vector<Move> moves;
+		if (!canAutoComplete())
+			return moves;
+
+		moves.reserve(52);
+		auto endIndices = endStacksIndices();
+
+		// Every pass moves all central top cards that fit, until nothing moves
+		// All cards are open and in order, so a pass never misses a card for long
+		bool moved = true;
+		while (moved)
+		{
+			moved = false;
+			for (size_t sourceIndex : centralStacksIndices())
+			{
+				CardStack& source = m_stacks[sourceIndex];
+				while (source.size() != 0)
+				{
+					const Card& card = source.cards().back();
+					auto destIt = std::find_if(endIndices.begin(), endIndices.end(), [this, &card](size_t endIndex) {
+						std::optional<Card> top = m_stacks[endIndex].top();
+						if (!top)
+							return card.number == 1;
+						return top->isSameSuit(card) && top->number + 1 == card.number;
+					});
+					if (destIt == endIndices.end())
+						break;
+
+					moves.push_back(Move{Move::Type::Cards, sourceIndex, source.topIndex(), *destIt});
+					m_endHeights[static_cast<size_t>(card.suit)] = card.number;
+					m_stacks[*destIt].append(std::move(*source.takeTop()));
+					placeCards(*destIt, m_stacks[*destIt].topIndex());
+					moved = true;
+				}
+			}
+		}
+
+		checkWin();
+		return moves;
+	}
+
+	template <class Rules>
+	size_t BasicGame<Rules>::closedCards(const CardStack& stack, size_t firstCardIndex) const
+	{
+		if (firstCardIndex >= stack.size())
+			return 0;
+		return stack.size() - firstCardIndex - stack.openCount(firstCardIndex);
+	}
+
+	template <class Rules>
+	CardSet BasicGame<Rules>::openCentralCards() const
+	{
+		CardSet cards = 0;
+		for (size_t stackIndex : centralStacksIndices())
+			cards |= m_stacks[stackIndex].openCardSet();
+		return cards;
+	}
+
+	template <class Rules>
+	CardSet BasicGame<Rules>::closedCentralCards() const
+	{
+		CardSet cards = 0;
+		for (size_t stackIndex : centralStacksIndices())
+			cards |= m_stacks[stackIndex].cardSet() & ~m_stacks[stackIndex].openCardSet();
+		return cards;
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::isSafeToEnd(const Card& card) const
+	{
+		// aces and twos are never needed to hold other cards
+		if (card.number <= 2)
+			return true;
+
+		// the card is still needed while a lower card that builds on it is not in the end stacks
+		// the rules are known at compile time, for Klondike this folds down to the two suits of the other color
+		for (size_t suitIndex = 0; suitIndex < m_endHeights.size(); ++suitIndex)
+		{
+			Card lower(card.number - 1, static_cast<Card::Suit>(suitIndex));
+			if (m_endHeights[suitIndex] < lower.number && Rules::canBuildOn(lower, card))
+				return false;
+		}
+		return true;
+	}
+
+	template <class Rules>
+	std::optional<size_t> BasicGame<Rules>::endStackFor(const Card& card) const
+	{
+		if (m_endHeights[static_cast<size_t>(card.suit)] != card.number - 1)
+			return std::nullopt;
+
+		// the card below it in the end stacks is already placed, only aces look for an empty stack
+		if (std::optional<Card> parent = endParent(card))
+		{
+			std::optional<CardLocation> location = locate(*parent);
+			if (location && isEndStack(location->stack) && isTopCard(*parent, location->stack))
+				return location->stack;
+			return std::nullopt;
+		}
+
+		for (size_t endIndex : endStacksIndices())
+		{
+			if (m_stacks[endIndex].size() == 0)
+				return endIndex;
+		}
+		return std::nullopt;
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::addCardMoves(std::vector<Move>& moves, size_t sourceStack, size_t cardIndex, const Card& card, bool isTop) const
+	{
+		// candidates are collected first, so moves come out ordered by destination as when every stack is tried
+		std::array<size_t, 13> dests;
+		size_t count = 0;
+
+		if (isTop)
+		{
+			if (std::optional<Card> parent = endParent(card))
+			{
+				std::optional<CardLocation> location = locate(*parent);
+				if (location && isEndStack(location->stack) && location->stack != sourceStack && isTopCard(*parent, location->stack))
+					dests[count++] = location->stack;
+			}
+			else
+			{
+				for (size_t endIndex : endStacksIndices())
+				{
+					if (endIndex != sourceStack && m_stacks[endIndex].size() == 0)
+						dests[count++] = endIndex;
+				}
+			}
+		}
+
+		if (Rules::canStartColumn(card))
+		{
+			for (size_t centralIndex : centralStacksIndices())
+			{
+				if (centralIndex != sourceStack && m_stacks[centralIndex].size() == 0)
+					dests[count++] = centralIndex;
+			}
+		}
+
+		// a parent on top of a central stack takes the card, open or not, as canMoveCards does
+		for (CardSet parents = centralParents(card); parents != 0; parents &= parents - 1)
+		{
+			const PackedLocation& location = m_locations[lowestBit(parents)];
+			if (isCentralStack(location.stack) && location.stack != sourceStack && location.index == m_stacks[location.stack].topIndex())
+				dests[count++] = location.stack;
+		}
+
+		std::sort(dests.begin(), dests.begin() + count);
+		for (size_t i = 0; i < count; ++i)
+			moves.push_back(Move{Move::Type::Cards, sourceStack, cardIndex, dests[i]});
+	}
+
+	template <class Rules>
+	std::optional<typename BasicGame<Rules>::CardLocation> BasicGame<Rules>::locate(const Card& card) const
+	{
+		size_t id = cardId(card);
+		if (id == cardCount || m_locations[id].stack == noStack)
+			return std::nullopt;
+		return CardLocation{m_locations[id].stack, m_locations[id].index};
+	}
+
+	template <class Rules>
+	CardSet BasicGame<Rules>::centralParents(const Card& card)
+	{
+		// every pair of cards is checked against the rules once, on first use
+		static const std::array<CardSet, cardCount> parents = []() {
+			std::array<CardSet, cardCount> table{};
+			for (size_t id = 0; id < cardCount; ++id)
+			{
+				for (size_t parentId = 0; parentId < cardCount; ++parentId)
+				{
+					if (Rules::canBuildOn(cardFromId(id), cardFromId(parentId)))
+						table[id] |= CardSet(1) << parentId;
+				}
+			}
+			return table;
+		}();
+
+		size_t id = cardId(card);
+		return id == cardCount ? 0 : parents[id];
+	}
+
+	template <class Rules>
+	std::optional<Card> BasicGame<Rules>::endParent(const Card& card)
+	{
+		if (card.number <= 1 || card.number > 13)
+			return std::nullopt;
+		return Card(card.number - 1, card.suit);
+	}
+
+	template <class Rules>
+	bool BasicGame<Rules>::isTopCard(const Card& card, size_t stack) const
+	{
+		size_t id = cardId(card);
+		return id != cardCount && m_locations[id].stack == stack && m_locations[id].index + size_t(1) == m_stacks[stack].size();
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::placeCards(size_t stack, size_t firstCardIndex)
+	{
+		const std::pmr::vector<Card>& cards = m_stacks[stack].cards();
+		for (size_t i = firstCardIndex; i < cards.size(); ++i)
+		{
+			size_t id = cardId(cards[i]);
+			if (id != cardCount)
+				m_locations[id] = PackedLocation{static_cast<uint8_t>(stack), static_cast<uint8_t>(i)};
+		}
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::placeStockCards(size_t first, size_t last)
+	{
+		// open stack card i is buffer card i, closed stack card j is buffer card size - 1 - j
+		// taking the top open card leaves every other index unchanged, only draws and recycles move cards
+		const std::pmr::vector<Card>& cards = m_stock.cards();
+		for (size_t i = first; i < last; ++i)
+		{
+			size_t id = cardId(cards[i]);
+			if (id == cardCount)
+				continue;
+			if (i < m_stock.openSize())
+				m_locations[id] = PackedLocation{1, static_cast<uint8_t>(i)};
+			else
+				m_locations[id] = PackedLocation{0, static_cast<uint8_t>(cards.size() - 1 - i)};
+		}
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::playSafeCards()
+	{
+		// moving a card can make the cards of the other color safe, repeat until nothing moves
+		bool moved = true;
+		while (moved)
+		{
+			moved = false;
+			while (std::optional<Card> card = m_stock.top())
+			{
+				std::optional<size_t> destIndex = isSafeToEnd(*card) ? endStackFor(*card) : std::nullopt;
+				if (!destIndex)
+					break;
+
+				m_endHeights[static_cast<size_t>(card->suit)] = card->number;
+				m_stacks[*destIndex].append(CardStack(std::pmr::vector<Card>{*m_stock.takeTop()}));
+				placeCards(*destIndex, m_stacks[*destIndex].topIndex());
+				stockChanged();
+				moved = true;
+			}
+
+			for (size_t sourceIndex : centralStacksIndices())
+			{
+				CardStack& source = m_stacks[sourceIndex];
+				while (source.size() != 0)
+				{
+					const Card& card = source.cards().back();
+					if (card.state == Card::State::Closed || !isSafeToEnd(card))
+						break;
+					std::optional<size_t> destIndex = endStackFor(card);
+					if (!destIndex)
+						break;
+
+					m_endHeights[static_cast<size_t>(card.suit)] = card.number;
+					m_stacks[*destIndex].append(std::move(*source.takeTop()));
+					placeCards(*destIndex, m_stacks[*destIndex].topIndex());
+					moved = true;
+				}
+			}
+		}
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::setAutoPlay(bool enabled)
+	{
+		m_autoPlay = enabled;
+		if (m_autoPlay && m_state == State::Playing)
+		{
+			playSafeCards();
+			checkWin();
+		}
+	}
+
+	template <class Rules>
+	void BasicGame<Rules>::reset(BasicGame&& other)
+	{
+		bool autoPlay = m_autoPlay;
+		size_t drawCount = m_stock.drawCount();
+		*this = other;
+		m_stock.setDrawCount(drawCount);
+		setAutoPlay(autoPlay);
+	}
+
+	template class BasicGame<KlondikeRules>;
+	template class BasicGame<KlondikeDrawThreeRules>;
+	template class BasicGame<VegasRules>;
+	template class BasicGame<ThumbAndPouchRules>;
 }
\ No newline at end of file
@@ -0,0 +1,255 @@
+#include "GameBatch.h"
+
+#include "GameBatchKernels.h"
+
+#include <algorithm>
+#include <assert.h>
+
+// SSE2 is part of every x86-64 target, AVX2 is looked for when the program runs
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define PANDA_BATCH_SSE2
+#	include <immintrin.h>
+#endif
+#if defined(PANDA_BATCH_AVX2) && defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+namespace panda
+{
+	namespace
+	{
+		using GameBatchKernels::computeBlockSimd;
+		using GameBatchKernels::firstCentral;
+
+		// Returns if the processor and the operating system support AVX2
+		bool cpuHasAvx2()
+		{
+#if defined(PANDA_BATCH_AVX2) && defined(_MSC_VER)
+			// the AVX registers also have to be saved by the operating system
+			int info[4];
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0;
+			if (!osxsave || (_xgetbv(0) & 6) != 6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#elif defined(PANDA_BATCH_AVX2)
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		}
+
+		// Reference kernel, one game and one pair of stacks at a time, with the rules of Game::canMoveCards
+		void computeBlockScalar(const GameBatch::Columns& c, uint32_t* top, uint32_t* run)
+		{
+			auto fitsEnd = [](uint8_t number, uint8_t suit, uint8_t destNumber, uint8_t destSuit) {
+				return number != 0 && number == destNumber + 1 && (destNumber == 0 || suit == destSuit);
+			};
+			auto fitsCentral = [](uint8_t number, uint8_t red, uint8_t destNumber, uint8_t destRed) {
+				if (number == 0)
+					return false;
+				return destNumber == 0 ? number == 13 : number + 1 == destNumber && red != destRed;
+			};
+
+			for (size_t lane = 0; lane < GameBatch::blockSize; ++lane)
+			{
+				for (size_t dest = 2; dest < GameBatch::stackCount; ++dest)
+				{
+					bool toEnd = Game::isEndStack(dest);
+					uint8_t destNumber = c.number[dest][lane];
+					for (size_t source = 1; source < GameBatch::stackCount; ++source)
+					{
+						if (source == dest)
+							continue;
+
+						uint8_t number = c.movable[source][lane] ? c.number[source][lane] : 0;
+						bool legal = toEnd ? fitsEnd(number, c.suit[source][lane], destNumber, c.suit[dest][lane])
+										   : fitsCentral(number, c.red[source][lane], destNumber, c.red[dest][lane]);
+						top[source * GameBatch::stackCount + dest] |= static_cast<uint32_t>(legal) << lane;
+
+						if (source < firstCentral)
+							continue;
+						size_t central = source - firstCentral;
+						bool runLegal = toEnd ? legal && c.openCount[central][lane] == 1
+											  : fitsCentral(c.baseNumber[central][lane], c.baseRed[central][lane], destNumber, c.red[dest][lane]);
+						run[central * GameBatch::stackCount + dest] |= static_cast<uint32_t>(runLegal) << lane;
+					}
+				}
+			}
+		}
+
+#ifdef PANDA_BATCH_SSE2
+		struct Sse2Lanes
+		{
+			using Vector = __m128i;
+			static constexpr size_t width = 16;
+
+			static Vector load(const uint8_t* lanes) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes)); }
+			static Vector set1(uint8_t value) { return _mm_set1_epi8(static_cast<char>(value)); }
+			static Vector equal(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+			static Vector add(Vector a, Vector b) { return _mm_add_epi8(a, b); }
+			static Vector bitAnd(Vector a, Vector b) { return _mm_and_si128(a, b); }
+			static Vector bitOr(Vector a, Vector b) { return _mm_or_si128(a, b); }
+			static Vector bitXor(Vector a, Vector b) { return _mm_xor_si128(a, b); }
+			static Vector andNot(Vector a, Vector b) { return _mm_andnot_si128(b, a); }    // a and not b
+			static uint32_t mask(Vector a) { return static_cast<uint32_t>(_mm_movemask_epi8(a)); }
+		};
+#endif
+
+	}
+
+	GameBatch::GameBatch(size_t size)
+		: m_size(size)
+		, m_blocks((size + blockSize - 1) / blockSize)
+	{
+		// padding lanes stay empty, an empty stack never has a legal move
+		size_t lanes = m_blocks * blockSize;
+		for (auto* columns : {&m_number, &m_suit, &m_red, &m_movable})
+		{
+			for (std::vector<uint8_t>& column : *columns)
+				column.assign(lanes, 0);
+		}
+		for (auto* columns : {&m_baseNumber, &m_baseRed, &m_openCount})
+		{
+			for (std::vector<uint8_t>& column : *columns)
+				column.assign(lanes, 0);
+		}
+		m_topMasks.assign(m_blocks * stackCount * stackCount, 0);
+		m_runMasks.assign(m_blocks * 7 * stackCount, 0);
+	}
+
+	void GameBatch::set(size_t index, const Game& game)
+	{
+		assert(index < m_size);
+		for (size_t stackIndex = 1; stackIndex < stackCount; ++stackIndex)
+		{
+			const CardStack& stack = game.stack(stackIndex);
+			std::optional<Card> top = stack.top();
+			m_number[stackIndex][index] = top ? static_cast<uint8_t>(top->number) : 0;
+			m_suit[stackIndex][index] = top ? static_cast<uint8_t>(top->suit) : 0;
+			m_red[stackIndex][index] = top && isRed(*top) ? 0xFF : 0;
+
+			// a closed central card has to be flipped first, the open and end stacks do not check it
+			bool movable = top && (!Game::isCentralStack(stackIndex) || top->state == Card::State::Open);
+			m_movable[stackIndex][index] = movable ? 0xFF : 0;
+
+			if (!Game::isCentralStack(stackIndex))
+				continue;
+
+			size_t central = stackIndex - firstCentral;
+			std::optional<size_t> firstOpen = movable ? stack.firstOpenCard() : std::nullopt;
+			const Card* base = firstOpen ? &stack.cards()[*firstOpen] : nullptr;
+			m_baseNumber[central][index] = base ? static_cast<uint8_t>(base->number) : 0;
+			m_baseRed[central][index] = base && isRed(*base) ? 0xFF : 0;
+			m_openCount[central][index] = firstOpen ? static_cast<uint8_t>(stack.size() - *firstOpen) : 0;
+		}
+	}
+
+	GameBatch::Kernel GameBatch::bestKernel()
+	{
+		if (isAvailable(Kernel::Avx2))
+			return Kernel::Avx2;
+		if (isAvailable(Kernel::Sse2))
+			return Kernel::Sse2;
+		return Kernel::Scalar;
+	}
+
+	bool GameBatch::isAvailable(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::Scalar:
+			return true;
+		case Kernel::Sse2:
+#ifdef PANDA_BATCH_SSE2
+			return true;
+#else
+			return false;
+#endif
+		case Kernel::Avx2:
+		{
+			static const bool available = GameBatchKernels::avx2Compiled() && cpuHasAvx2();
+			return available;
+		}
+		}
+		return false;
+	}
+
+	const char* GameBatch::kernelName(Kernel kernel)
+	{
+		switch (kernel)
+		{
+		case Kernel::Scalar:
+			return "scalar";
+		case Kernel::Sse2:
+			return "sse2";
+		case Kernel::Avx2:
+			return "avx2";
+		}
+		return "";
+	}
+
+	void GameBatch::computeMasks(Kernel kernel)
+	{
+		if (!isAvailable(kernel))
+			kernel = Kernel::Scalar;
+
+		std::fill(m_topMasks.begin(), m_topMasks.end(), 0);
+		std::fill(m_runMasks.begin(), m_runMasks.end(), 0);
+		for (size_t block = 0; block < m_blocks; ++block)
+		{
+			Columns lanes = columns(block);
+			uint32_t* top = &m_topMasks[block * stackCount * stackCount];
+			uint32_t* run = &m_runMasks[block * 7 * stackCount];
+			switch (kernel)
+			{
+			case Kernel::Avx2:
+				GameBatchKernels::computeBlockAvx2(lanes, top, run);
+				break;
+#ifdef PANDA_BATCH_SSE2
+			case Kernel::Sse2:
+				computeBlockSimd<Sse2Lanes>(lanes, top, run);
+				break;
+#endif
+			default:
+				computeBlockScalar(lanes, top, run);
+				break;
+			}
+		}
+	}
+
+	bool GameBatch::canMoveTop(size_t game, size_t sourceStack, size_t destStack) const
+	{
+		if (game >= m_size || sourceStack >= stackCount || destStack >= stackCount)
+			return false;
+		return (topMask(game / blockSize, sourceStack, destStack) >> (game % blockSize)) & 1;
+	}
+
+	bool GameBatch::canMoveRun(size_t game, size_t sourceStack, size_t destStack) const
+	{
+		if (game >= m_size || !Game::isCentralStack(sourceStack) || destStack >= stackCount)
+			return false;
+		return (runMask(game / blockSize, sourceStack, destStack) >> (game % blockSize)) & 1;
+	}
+
+	GameBatch::Columns GameBatch::columns(size_t block) const
+	{
+		size_t first = block * blockSize;
+		Columns lanes;
+		for (size_t stackIndex = 0; stackIndex < stackCount; ++stackIndex)
+		{
+			lanes.number[stackIndex] = m_number[stackIndex].data() + first;
+			lanes.suit[stackIndex] = m_suit[stackIndex].data() + first;
+			lanes.red[stackIndex] = m_red[stackIndex].data() + first;
+			lanes.movable[stackIndex] = m_movable[stackIndex].data() + first;
+		}
+		for (size_t central = 0; central < 7; ++central)
+		{
+			lanes.baseNumber[central] = m_baseNumber[central].data() + first;
+			lanes.baseRed[central] = m_baseRed[central].data() + first;
+			lanes.openCount[central] = m_openCount[central].data() + first;
+		}
+		return lanes;
+	}
+}
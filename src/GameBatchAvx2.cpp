@@ -0,0 +1,102 @@
+#include "GameBatchKernels.h"
+
+#include <assert.h>
+
+#if defined(PANDA_BATCH_AVX2)
+#	include <immintrin.h>
+#endif
+
+// only the functions marked here are built for AVX2, inline functions shared with other files keep the baseline instructions
+// MSVC takes AVX2 intrinsics in any function
+#if defined(PANDA_BATCH_AVX2) && defined(__GNUC__)
+#	define PANDA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#	define PANDA_TARGET_AVX2
+#endif
+
+namespace panda
+{
+	namespace GameBatchKernels
+	{
+#if defined(PANDA_BATCH_AVX2)
+		namespace
+		{
+			// the lanes of computeBlockSimd, as functions of this file that can be built for AVX2
+			using Vector = __m256i;
+			constexpr size_t width = 32;
+
+			PANDA_TARGET_AVX2 inline Vector load(const uint8_t* lanes) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes)); }
+			PANDA_TARGET_AVX2 inline Vector set1(uint8_t value) { return _mm256_set1_epi8(static_cast<char>(value)); }
+			PANDA_TARGET_AVX2 inline Vector equal(Vector a, Vector b) { return _mm256_cmpeq_epi8(a, b); }
+			PANDA_TARGET_AVX2 inline Vector add(Vector a, Vector b) { return _mm256_add_epi8(a, b); }
+			PANDA_TARGET_AVX2 inline Vector bitAnd(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+			PANDA_TARGET_AVX2 inline Vector bitOr(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+			PANDA_TARGET_AVX2 inline Vector bitXor(Vector a, Vector b) { return _mm256_xor_si256(a, b); }
+			PANDA_TARGET_AVX2 inline Vector andNot(Vector a, Vector b) { return _mm256_andnot_si256(b, a); }    // a and not b
+			PANDA_TARGET_AVX2 inline uint32_t mask(Vector a) { return static_cast<uint32_t>(_mm256_movemask_epi8(a)); }
+
+			PANDA_TARGET_AVX2 inline Vector fitsCentral(Vector cardNumber, Vector cardRed, Vector destNumber, Vector destRed, Vector destEmpty)
+			{
+				const Vector zero = set1(0);
+				Vector build = bitAnd(equal(add(cardNumber, set1(1)), destNumber), bitXor(cardRed, destRed));
+				build = andNot(build, equal(cardNumber, zero));
+				return bitOr(bitAnd(destEmpty, equal(cardNumber, set1(13))), andNot(build, destEmpty));
+			}
+		}
+
+		// computeBlockSimd written out with the lanes above, the shared template would be built without AVX2
+		PANDA_TARGET_AVX2 void computeBlockAvx2(const GameBatch::Columns& c, uint32_t* top, uint32_t* run)
+		{
+			const Vector zero = set1(0);
+			const Vector one = set1(1);
+
+			for (size_t offset = 0; offset < GameBatch::blockSize; offset += width)
+			{
+				Vector number[GameBatch::stackCount];
+				Vector sourceNumber[GameBatch::stackCount];    // zero when the top card cannot leave
+				Vector suit[GameBatch::stackCount];
+				Vector red[GameBatch::stackCount];
+				for (size_t stack = 1; stack < GameBatch::stackCount; ++stack)
+				{
+					number[stack] = load(c.number[stack] + offset);
+					sourceNumber[stack] = bitAnd(number[stack], load(c.movable[stack] + offset));
+					suit[stack] = load(c.suit[stack] + offset);
+					red[stack] = load(c.red[stack] + offset);
+				}
+
+				for (size_t dest = 2; dest < GameBatch::stackCount; ++dest)
+				{
+					bool toEnd = Game::isEndStack(dest);
+					Vector destEmpty = equal(number[dest], zero);
+					Vector next = add(number[dest], one);
+					for (size_t source = 1; source < GameBatch::stackCount; ++source)
+					{
+						if (source == dest)
+							continue;
+
+						Vector legal = toEnd ? bitAnd(equal(sourceNumber[source], next), bitOr(destEmpty, equal(suit[source], suit[dest])))
+											 : fitsCentral(sourceNumber[source], red[source], number[dest], red[dest], destEmpty);
+						top[source * GameBatch::stackCount + dest] |= mask(legal) << offset;
+
+						if (source < firstCentral)
+							continue;
+						size_t central = source - firstCentral;
+						Vector runLegal;
+						if (toEnd)
+							runLegal = bitAnd(legal, equal(load(c.openCount[central] + offset), one));
+						else
+							runLegal = fitsCentral(load(c.baseNumber[central] + offset), load(c.baseRed[central] + offset), number[dest], red[dest], destEmpty);
+						run[central * GameBatch::stackCount + dest] |= mask(runLegal) << offset;
+					}
+				}
+			}
+		}
+
+		bool avx2Compiled() { return true; }
+#else
+		void computeBlockAvx2(const GameBatch::Columns&, uint32_t*, uint32_t*) { assert(false); }
+
+		bool avx2Compiled() { return false; }
+#endif
+	}
+}
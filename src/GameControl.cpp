@@ -2,7 +2,9 @@
 
 #include "CardStack.h"
 #include "Game.h"
+#include "HintEngine.h"
 #include "Layout.h"
+#include "Profiler.h"
 
 #include <iostream>
 namespace panda
@@ -13,15 +15,54 @@ namespace panda
 		return stack;
 	}
 
-	GameControl::GameControl(Game& game, Layout& gameLayout)
+	GameControl::GameControl(Game& game, Layout& gameLayout, HintEngine& hints)
 		: m_game(game)
 		, m_layout(gameLayout)
+		, m_hints(hints)
 	{
 	}
 
 	void GameControl::reset()
 	{
 		m_sel.reset();
+		m_hintRequested = false;
+	}
+
+	bool GameControl::hintPending() const
+	{
+		return m_hintRequested;
+	}
+
+	void GameControl::requestHint()
+	{
+		m_hintHash = m_game.hash();
+		m_hintRequested = true;
+		m_hints.request(m_game);    // returns straight away, cached states are not searched again
+	}
+
+	void GameControl::updateHint()
+	{
+		if (!m_sel.hint && !m_hintRequested)
+			return;
+
+		// a hint only applies to the state it was asked for
+		if (m_game.hash() != m_hintHash)
+		{
+			m_sel.hint.reset();
+			m_hintRequested = false;
+			return;
+		}
+
+		if (m_hintRequested && m_hints.searched(m_game))
+		{
+			m_sel.hint = m_hints.hint(m_game);
+			m_hintRequested = false;
+		}
+		else if (m_hintRequested && !m_hints.searching())
+		{
+			// an engine shared between games drops a request when another one comes in, ask again once it is idle
+			m_hints.request(m_game);
+		}
 	}
 
 	bool GameControl::isCentralStack()
@@ -81,6 +122,7 @@ namespace panda
 
 	void GameControl::action(const Action& action)
 	{
+		PANDA_PROFILE_SCOPE("GameControl::action");
 		if (action == Action::Up)
 		{
 			if (isCentralStack())
@@ -158,9 +200,14 @@ namespace panda
 				m_sel.markedCardIndex = 0;
 			}
 		}
+		else if (action == Action::Hint)
+		{
+			requestHint();
+		}
 
 		// check if there is a win after every action
 		m_game.checkWin();
+		updateHint();
 	}
 
 	const GameSelection& GameControl::selection() const
@@ -11,20 +11,33 @@ namespace panda
 {
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(Card, number, state, suit)
 	void to_json(json& j, const CardStack& stack) { j = json{{"cards", stack.cards()}}; }
-	void to_json(json& j, const Game& game) { j = json{{"stacks", game.stacks()}}; }
+	void to_json(json& j, const Game& game) { j = json{{"stacks", game.stacks()}, {"drawCount", game.drawCount()}}; }
 
 	namespace GameFileIO
 	{
+		namespace
+		{
+			std::filesystem::path saveFilePath()
+			{
+				auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
+				return pathDir.append("saveFile.json");
+			}
+		}
+
 		bool saveGame(const Game& game)
+		{
+			auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
+			std::filesystem::create_directory(pathDir);
+			return saveGame(game, saveFilePath());
+		}
+
+		bool saveGame(const Game& game, const std::filesystem::path& path)
 		{
 			json gameJson = game;
 
 			// open file to write
-			auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
-			std::filesystem::create_directory(pathDir);
-			auto fullPath = pathDir.append("saveFile.json");
 			std::ofstream file;
-			file.open(fullPath);
+			file.open(path);
 			if (!file.is_open())
 				return false;
 
@@ -32,14 +45,13 @@ namespace panda
 			return true;
 		}
 
-		std::optional<Game> loadGame()
+		std::optional<Game> loadGame() { return loadGame(saveFilePath()); }
+
+		std::optional<Game> loadGame(const std::filesystem::path& path)
 		{
-			// save to file in appdata
-			auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
-			auto fullPath = pathDir.append("saveFile.json");
 			// open file to read
 			std::ifstream file;
-			file.open(fullPath);
+			file.open(path);
 			if (!file.is_open())
 				return std::nullopt;
 
@@ -48,7 +60,7 @@ namespace panda
 				json gameJson = json::parse(file);
 
 
-				std::vector<Card> cards;
+				std::pmr::vector<Card> cards;
 
 				json& stacks = gameJson.at("stacks");
 				stacks.at(0).at("cards").get_to(cards);
@@ -72,6 +84,7 @@ namespace panda
 				}
 
 				Game game(Game::Stacks{std::move(endStack), std::move(centralStack), std::move(closedStack), std::move(openStack)});
+				game.setDrawCount(gameJson.value("drawCount", static_cast<size_t>(1)));    // older saves only drew one card
 				return game;
 			}
 			catch (std::exception&)
@@ -80,11 +93,6 @@ namespace panda
 			return std::nullopt;
 		}
 
-		bool hasSavedGame() 
-		{
-			auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
-			auto fullPath = pathDir.append("saveFile.json");
-			return std::filesystem::exists(fullPath);
-		}
+		bool hasSavedGame() { return std::filesystem::exists(saveFilePath()); }
 	}
 }
\ No newline at end of file
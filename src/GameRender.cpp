@@ -5,10 +5,14 @@
 #include "Game.h"
 #include "GameControl.h"
 #include "Layout.h"
+#include "Profiler.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 namespace panda
 {
@@ -19,7 +23,6 @@ namespace panda
 		, m_console(console)
 	{
 		m_console.setClearColor(m_clearColor);
-		update();
 	}
 
 	std::optional<vec2i> GameRender::indexToConsole(size_t index)
@@ -33,16 +36,29 @@ namespace panda
 		return {vec2i{outX, outY}};
 	}
 
+	int GameRender::right() const
+	{
+		// the layout has every stack index from 0 on
+		int columns = 0;
+		for (size_t index = 0; auto layout = m_layout.indexToLayout(index); ++index)
+			columns = std::max(columns, layout->first + 1);
+		return m_stackSpacing + (m_stackSpacing + m_cardWidth) * columns;
+	}
+
 	std::optional<vec2i> GameRender::position(size_t stackIndex, size_t cardIndex)
+	{
+		if (stackIndex >= m_game.stacks().size())
+			return {};
+		return position(m_game.stacks()[stackIndex], stackIndex, cardIndex);
+	}
+
+	std::optional<vec2i> GameRender::position(const CardStack& stack, size_t stackIndex, size_t cardIndex)
 	{
 		auto layout = indexToConsole(stackIndex);
 		if (!layout)
 			return {};
 		auto [x, y] = *layout;
 
-		const std::vector<CardStack>& stacks = m_game.stacks();
-		const CardStack& stack = stacks[stackIndex];
-
 		if (m_game.isCentralStack(stackIndex))
 		{
 			auto openCardIndex = stack.firstOpenCard();
@@ -65,13 +81,25 @@ namespace panda
 				}
 			}
 		}
+		else if (m_game.isOpenStack(stackIndex))
+		{
+			size_t firstFanned = firstFannedCard(stack);
+			if (cardIndex > firstFanned)
+				x += static_cast<int>(cardIndex - firstFanned) * m_cardFanWidth;
+		}
 
 		return vec2i{x, y};
 	}
 
+	size_t GameRender::firstFannedCard(const CardStack& openStack) const
+	{
+		size_t fanned = m_game.drawCount();
+		return openStack.size() > fanned ? openStack.size() - fanned : 0;
+	}
+
 	void GameRender::renderStacks()
 	{
-		const std::vector<CardStack>& stacks = m_game.stacks();
+		const std::pmr::vector<CardStack>& stacks = m_game.stacks();
 
 		// render game layout, with mapping to console positions
 		for (int index = 0; index < stacks.size(); ++index)
@@ -115,6 +143,15 @@ namespace panda
 					continue;
 				drawCard(*std::prev(stack.cards().end()), *pos);
 			}
+			else if (m_game.isOpenStack(index))
+			{
+				// fan the last drawn cards left to right, the top card fully visible
+				for (size_t cardIndex = firstFannedCard(stack); cardIndex < stack.size(); ++cardIndex)
+				{
+					if (auto pos = position(index, cardIndex))
+						drawCard(stack.cards()[cardIndex], *pos);
+				}
+			}
 			else
 			{
 				auto pos = position(index, 0);
@@ -141,9 +178,72 @@ namespace panda
 		drawControlMark(*pos);
 	}
 
+	void GameRender::renderHint(const Move& move)
+	{
+		// mark the card the hinted move starts from, and where it goes
+		if (auto pos = position(move.sourceStack, move.sourceCard))
+			drawControlMark(*pos);
+
+		if (move.type != Move::Type::Cards)
+			return;
+
+		const CardStack& dest = m_game.stacks()[move.destStack];
+		if (auto pos = position(move.destStack, dest.size() == 0 ? 0 : dest.topIndex()))
+			drawControlMark(*pos);
+	}
+
+	void GameRender::playback(const Game& from, const std::vector<Move>& moves)
+	{
+		Game state = from;
+		for (const Move& move : moves)
+		{
+			auto frameStart = std::chrono::steady_clock::now();
+
+			m_console.beginUpdate();
+			drawMove(state, move);
+			m_console.endUpdate();
+
+			state.applyMove(move);
+			std::this_thread::sleep_until(frameStart + m_playbackFrameTime);
+		}
+	}
+
+	void GameRender::drawMove(const Game& state, const Move& move)
+	{
+		if (move.type != Move::Type::Cards)
+			return;
+
+		const CardStack& source = state.stacks()[move.sourceStack];
+		const CardStack& dest = state.stacks()[move.destStack];
+		auto sourcePos = position(source, move.sourceStack, move.sourceCard);
+		auto destPos = position(dest, move.destStack, dest.size());
+		if (!sourcePos || !destPos)
+			return;
+
+		// clear the moving cards, and show the card they uncover as the new top
+		int movedHeight = static_cast<int>(source.size() - move.sourceCard) * m_cardHeight;
+		m_console.setDrawColor(m_clearColor, m_clearColor);
+		m_console.drawRect(sourcePos->first, sourcePos->second, m_cardWidth, movedHeight);
+		if (move.sourceCard > 0)
+		{
+			if (auto belowPos = position(source, move.sourceStack, move.sourceCard - 1))
+				drawCard(source.cards()[move.sourceCard - 1], *belowPos);
+		}
+		else if (state.isCentralStack(move.sourceStack))
+		{
+			drawEmpty('K', *sourcePos);
+		}
+		else
+		{
+			drawEmpty(*sourcePos);
+		}
+
+		drawCard(source.cards()[move.sourceCard], *destPos);
+	}
+
 	void GameRender::update()
 	{
-		m_console.begin();
+		PANDA_PROFILE_SCOPE("GameRender::update");
 		renderStacks();
 		// render game control
 		{
@@ -154,9 +254,20 @@ namespace panda
 			{
 				renderControlMark();
 			}
+
+			if (m_selection.hint)
+				renderHint(*m_selection.hint);
 		}
 
-		m_console.end();
+		if (m_game.state() == Game::State::Lose)
+			renderLose();
+	}
+
+	void GameRender::renderLose()
+	{
+		// above the stacks, the row the layout leaves free
+		m_console.setDrawColor(m_loseColor);
+		m_console.draw("No move can help any more, the game is lost", m_stackSpacing, m_stackSpacing / 2);
 	}
 
 	std::optional<int> cardColor(const Card& card)
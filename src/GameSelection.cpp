@@ -9,5 +9,6 @@ namespace panda
 		stackIndex = 0;
 		markedCardIndex = 0;
 		markedStackIndex = 0;
+		hint.reset();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "GameTensor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace panda
+{
+	namespace GameTensor
+	{
+		void encode(const Game& game, float* tensor)
+		{
+			// most of the tensor is zero, the cards only set one value per plane
+			std::fill(tensor, tensor + size, 0.0f);
+
+			const auto& stacks = game.stacks();
+			for (size_t id = 0; id < cardCount; ++id)
+			{
+				std::optional<Game::CardLocation> location = game.locate(cardFromId(id));
+				if (!location)
+					continue;
+				tensor[locationOffset + id * stackCount + location->stack] = 1.0f;
+				tensor[openOffset + id] = stacks[location->stack].cards()[location->index].state == Card::State::Open ? 1.0f : 0.0f;
+				tensor[indexOffset + id] = static_cast<float>(location->index);
+			}
+
+			const auto& stock = game.stock().cards();
+			for (size_t position = 0; position < stock.size() && position < stockCapacity; ++position)
+			{
+				size_t id = cardId(stock[position]);
+				if (id < cardCount)
+					tensor[stockOffset + id * stockCapacity + position] = 1.0f;
+			}
+
+			for (size_t suit = 0; suit < 4; ++suit)
+				tensor[endOffset + suit] = static_cast<float>(game.endHeight(static_cast<Card::Suit>(suit)));
+			tensor[drawCountOffset] = static_cast<float>(game.drawCount());
+		}
+
+		void encodeBatch(const Game* games, size_t count, float* tensor)
+		{
+			for (size_t i = 0; i < count; ++i)
+				encode(games[i], tensor + i * size);
+		}
+
+		std::optional<Game> decode(const float* tensor)
+		{
+			float drawCount = tensor[drawCountOffset];
+			if (drawCount != 1.0f && drawCount != 3.0f)
+				return std::nullopt;
+
+			// every card goes to the slot of its index, a slot taken twice or left empty is no position
+			std::array<std::array<std::optional<Card>, cardCount>, stackCount> slots;
+			std::array<size_t, stackCount> sizes{};
+			for (size_t id = 0; id < cardCount; ++id)
+			{
+				const float* locations = tensor + locationOffset + id * stackCount;
+				auto stack = std::find(locations, locations + stackCount, 1.0f);
+				if (stack == locations + stackCount || std::count(locations, locations + stackCount, 1.0f) != 1)
+					return std::nullopt;
+
+				size_t stackIndex = static_cast<size_t>(stack - locations);
+				// the negated compare also turns away NaN, fractions would be cut off by the cast
+				float index = tensor[indexOffset + id];
+				if (!(index >= 0.0f && index < static_cast<float>(cardCount)) || index != std::floor(index) || slots[stackIndex][static_cast<size_t>(index)])
+					return std::nullopt;
+
+				Card card = cardFromId(id);
+				card.state = tensor[openOffset + id] == 1.0f ? Card::State::Open : Card::State::Closed;
+				slots[stackIndex][static_cast<size_t>(index)] = card;
+				sizes[stackIndex]++;
+			}
+
+			std::array<CardStack, stackCount> stacks;
+			for (size_t stackIndex = 0; stackIndex < stackCount; ++stackIndex)
+			{
+				std::pmr::vector<Card> cards;
+				cards.reserve(sizes[stackIndex]);
+				for (size_t index = 0; index < sizes[stackIndex]; ++index)
+				{
+					if (!slots[stackIndex][index])
+						return std::nullopt;
+					cards.push_back(*slots[stackIndex][index]);
+				}
+				stacks[stackIndex] = CardStack(std::move(cards));
+			}
+
+			std::array<CardStack, 4> endStack{stacks[2], stacks[3], stacks[4], stacks[5]};
+			std::array<CardStack, 7> centralStack{stacks[6], stacks[7], stacks[8], stacks[9], stacks[10], stacks[11], stacks[12]};
+			Game game(Game::Stacks(std::move(endStack), std::move(centralStack), std::move(stacks[0]), std::move(stacks[1])));
+			game.setDrawCount(static_cast<size_t>(drawCount));
+			game.checkWin();
+			game.checkLose();
+			return game;
+		}
+	}
+}
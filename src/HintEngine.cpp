@@ -0,0 +1,123 @@
+#include "HintEngine.h"
+
+namespace panda
+{
+	namespace
+	{
+		// Bound on cached states, the cache starts over when reached
+		const size_t maxCachedStates = 1 << 16;
+	}
+
+	HintEngine::HintEngine()
+		: HintEngine(Solver::Limits{})
+	{
+	}
+
+	HintEngine::HintEngine(Solver::Limits limits)
+		: m_limits(limits)
+	{
+		m_limits.cancelled = &m_cancel;
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	HintEngine::~HintEngine()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+			m_cancel = true;
+		}
+		m_requested.notify_one();
+		m_thread.join();
+	}
+
+	bool HintEngine::searched(const Game& game) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_cache.find(game.hash()) != m_cache.end();
+	}
+
+	std::optional<Move> HintEngine::hint(const Game& game) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_cache.find(game.hash());
+		if (it == m_cache.end())
+			return {};
+		return it->second;
+	}
+
+	void HintEngine::request(const Game& game)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_cache.find(game.hash()) != m_cache.end())
+				return;
+
+			// the latest request replaces anything older, there is no point finishing it
+			m_pending = game;
+			m_cancel = true;
+		}
+		m_requested.notify_one();
+	}
+
+	bool HintEngine::searching() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pending.has_value() || m_searching;
+	}
+
+	void HintEngine::run()
+	{
+		Solver solver(m_limits);
+		while (true)
+		{
+			std::optional<Game> game;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_searching = false;
+				m_requested.wait(lock, [this]() { return m_stop || m_pending.has_value(); });
+				if (m_stop)
+					return;
+
+				game = std::move(m_pending);
+				m_pending.reset();
+				m_cancel = false;
+				m_searching = true;
+			}
+
+			Solver::Solution solution = solver.solve(*game);
+			store(*game, solution);
+		}
+	}
+
+	void HintEngine::store(const Game& game, const Solver::Solution& solution)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// cancelled searches are incomplete, a new one is already waiting
+		if (m_cancel)
+			return;
+
+		if (m_cache.size() >= maxCachedStates)
+			m_cache.clear();
+
+		if (solution.result == Solver::Result::Solved)
+		{
+			// following the hint leads through these states, cache all of them
+			Game state = game;
+			for (const Move& move : solution.moves)
+			{
+				m_cache[state.hash()] = move;
+				state.applyMove(move);
+			}
+			return;
+		}
+
+		// no winning line found in time, suggest the most promising move instead
+		std::vector<Move> candidates = Solver::candidateMoves(game);
+		if (candidates.empty())
+			m_cache[game.hash()] = std::nullopt;
+		else
+			m_cache[game.hash()] = candidates.front();
+	}
+}
@@ -7,6 +7,11 @@
 
 namespace panda
 {
+	Graph::Graph(const Graph& other, std::pmr::memory_resource* resource)
+		: m_nodes(other.m_nodes, resource)
+	{
+	}
+
 	void Graph::addNode(Graph::Node&& node)
 	{
 		m_nodes.push_back(node);
@@ -83,7 +88,7 @@ namespace panda
 			return;
 
 		// init first to first index of chain
-		std::vector<Node>::iterator firstIt = nodeIt(*chain.begin());
+		std::pmr::vector<Node>::iterator firstIt = nodeIt(*chain.begin());
 		for (auto second = std::next(chain.begin()); second != chain.end(); second++)
 		{
 			// second to next index in chain
@@ -118,7 +123,7 @@ namespace panda
 		return *it;
 	}
 
-	std::vector<Graph::Node>::iterator Graph::nodeIt(size_t index)
+	std::pmr::vector<Graph::Node>::iterator Graph::nodeIt(size_t index)
 	{
 		return std::find_if(m_nodes.begin(), m_nodes.end(), [&index](const Node& node) -> bool { return node.index == index; });
 	}
@@ -128,6 +133,11 @@ namespace panda
 	{
 	}
 
+	Layout::Layout(const Layout& other, std::pmr::memory_resource* resource)
+		: m_graph(other.m_graph, resource)
+	{
+	}
+
 	// Mapping between the layout and stacks index
 	std::optional<size_t> Layout::layoutToIndex(int x, int y) const
 	{
@@ -183,4 +193,61 @@ namespace panda
 			return index;
 		return *node->right;
 	}
+
+	Layout createGameLayout()
+	{
+		// map game to the layout, where top row contains open, closed, end stacks, and bottom row contains central stacks
+		// bottom row is one index down
+		// layout is as follows:
+		// 0:closed	| 1:open	| -			| 2:end0	| 3:end1	| 4:end2	| 5:end3	|
+		// 6:cen0	| 7:cen1	| 8:cen2	| 9:cen3	| 10:cen4	| 11:cen5	| 12:cen6	|
+		Graph graph;
+		graph.addNode(0, {0, 0});
+		graph.addNode(1, {1, 0});
+		graph.addNode(2, {3, 0});
+		graph.addNode(3, {4, 0});
+		graph.addNode(4, {5, 0});
+		graph.addNode(5, {6, 0});
+		graph.addNode(6, {0, 1});
+		graph.addNode(7, {1, 1});
+		graph.addNode(8, {2, 1});
+		graph.addNode(9, {3, 1});
+		graph.addNode(10, {4, 1});
+		graph.addNode(11, {5, 1});
+		graph.addNode(12, {6, 1});
+
+		graph.addHorChain({0, 1, 2, 3, 4, 5});
+		graph.addHorChain({6, 7, 8, 9, 10, 11, 12});
+
+		graph.addVerEdge(0, 6);
+		graph.addVerEdge(1, 7);
+		graph.addVerEdge(2, 9);
+		graph.addVerEdge(3, 10);
+		graph.addVerEdge(4, 11);
+		graph.addVerEdge(5, 12);
+
+		// add an edge that only goes up
+		graph.addUpEdge(8, 1);
+		return Layout(std::move(graph));
+	}
+
+	Layout createFreeCellLayout()
+	{
+		// top row contains the free cells and the end stacks, bottom row the central stacks, each column lines up
+		// 0:cell0	| 1:cell1	| 2:cell2	| 3:cell3	| 4:end0	| 5:end1	| 6:end2	| 7:end3	|
+		// 8:cen0	| 9:cen1	| 10:cen2	| 11:cen3	| 12:cen4	| 13:cen5	| 14:cen6	| 15:cen7	|
+		Graph graph;
+		for (size_t column = 0; column < 8; ++column)
+		{
+			graph.addNode(column, {column, 0});
+			graph.addNode(column + 8, {column, 1});
+		}
+
+		graph.addHorChain({0, 1, 2, 3, 4, 5, 6, 7});
+		graph.addHorChain({8, 9, 10, 11, 12, 13, 14, 15});
+
+		for (size_t column = 0; column < 8; ++column)
+			graph.addVerEdge(column, column + 8);
+		return Layout(std::move(graph));
+	}
 }
@@ -27,9 +27,9 @@ namespace panda
 		}
 	}
 
-	MenuControl::MenuControl(const Menu& menu)
+	MenuControl::MenuControl(const Menu& menu, std::pmr::memory_resource* resource)
 		: m_menu(menu)
-		, m_layout(createMenuLayout(menu.options().size()))
+		, m_layout(createMenuLayout(menu.options().size()), resource)
 	{
 	}
 
@@ -45,7 +45,7 @@ namespace panda
 			break;
 		case Action::Use:
 		{
-			auto opts = m_menu.options();
+			const auto& opts = m_menu.options();
 			if (m_selection.index() < opts.size())
 			{
 				if (auto func = opts.at(m_selection.index()).second)
@@ -26,8 +26,6 @@ namespace panda
 
 	void MenuRender::update()
 	{
-		m_console.begin();
-
 		int xLoc = topMargin;
 		int yLoc = leftMargin;
 
@@ -43,19 +41,17 @@ namespace panda
 		yLoc += ySpacing;
 
 		std::vector<int> yOptLocs;
-		for (const auto& opt : m_menu.optionNames())
+		for (const Option& opt : m_menu.options())
 		{
-			m_console.draw(opt, xLoc, yLoc);
+			m_console.draw(opt.first, xLoc, yLoc);
 			yOptLocs.push_back(yLoc);
 			yLoc += yOptSpacing;
 		}
 
 		// draw control on top
 		size_t selectedOpt = m_selection.index();
-		int optWidth = static_cast<int>(m_menu.optionNames().at(selectedOpt).size());
+		int optWidth = static_cast<int>(m_menu.options().at(selectedOpt).first.size());
 		drawControl({xLoc, yOptLocs[selectedOpt]}, optWidth);
-
-		m_console.end();
 	}
 
 	void MenuRender::drawControl(vec2i pos, int width)
@@ -0,0 +1,231 @@
+#include "PackedGame.h"
+
+#include "CardSet.h"
+
+#include <algorithm>
+
+namespace panda
+{
+	namespace
+	{
+		constexpr unsigned cardBits = 6;
+		constexpr unsigned stockSizeBits = 5;
+		constexpr unsigned stackSizeBits = 5;
+		constexpr unsigned endHeightBits = 4;
+		constexpr size_t centralCount = 7;
+		constexpr size_t emptyStackKey = 0xFF;
+
+		// the recycles are not packed, a game turns its stock over as often as it likes
+		static_assert(Game::RulesType::recycleLimit == unlimitedRecycles);
+
+		// new suit of every suit, indexed by suit
+		using SuitMap = std::array<uint8_t, 4>;
+
+		// the suit swaps that keep the colors apart, hearts and diamonds are red, clubs and spades black
+		constexpr std::array<SuitMap, 8> suitMaps{{
+			{0, 1, 2, 3},
+			{1, 0, 2, 3},
+			{0, 1, 3, 2},
+			{1, 0, 3, 2},
+			{2, 3, 0, 1},
+			{3, 2, 0, 1},
+			{2, 3, 1, 0},
+			{3, 2, 1, 0},
+		}};
+
+		class BitWriter
+		{
+		public:
+			explicit BitWriter(std::array<uint64_t, PackedGame::wordCount>& words)
+				: m_words(words)
+			{
+			}
+
+			void write(uint64_t value, unsigned bits)
+			{
+				// a value crosses at most one word boundary
+				size_t word = m_position / 64;
+				unsigned shift = static_cast<unsigned>(m_position % 64);
+				m_words[word] |= value << shift;
+				if (shift + bits > 64)
+					m_words[word + 1] |= value >> (64 - shift);
+				m_position += bits;
+			}
+
+		private:
+			std::array<uint64_t, PackedGame::wordCount>& m_words;
+			size_t m_position = 0;
+		};
+
+		class BitReader
+		{
+		public:
+			explicit BitReader(const std::array<uint64_t, PackedGame::wordCount>& words)
+				: m_words(words)
+			{
+			}
+
+			uint64_t read(unsigned bits)
+			{
+				if (m_position + bits > PackedGame::wordCount * 64)
+					return 0;
+				size_t word = m_position / 64;
+				unsigned shift = static_cast<unsigned>(m_position % 64);
+				uint64_t value = m_words[word] >> shift;
+				if (shift + bits > 64)
+					value |= m_words[word + 1] << (64 - shift);
+				m_position += bits;
+				return value & lowBits(bits);
+			}
+
+		private:
+			const std::array<uint64_t, PackedGame::wordCount>& m_words;
+			size_t m_position = 0;
+		};
+
+		uint64_t mappedId(const Card& card, const SuitMap& map) { return map[static_cast<size_t>(card.suit)] * 13 + static_cast<uint64_t>(card.number - 1); }
+
+		PackedGame encodeMapped(const Game& game, const SuitMap& map)
+		{
+			PackedGame packed;
+			BitWriter out(packed.words);
+
+			const Stock& stock = game.stock();
+			out.write(game.drawCount() == 3 ? 1 : 0, 1);
+			out.write(stock.openSize(), stockSizeBits);
+			out.write(stock.size(), stockSizeBits);
+
+			std::array<int, 4> heights{};
+			for (size_t suit = 0; suit < 4; ++suit)
+				heights[map[suit]] = game.endHeight(static_cast<Card::Suit>(suit));
+			for (int height : heights)
+				out.write(static_cast<uint64_t>(height), endHeightBits);
+
+			for (const Card& card : stock.cards())
+				out.write(mappedId(card, map), cardBits);
+
+			// every card is in one place, so the bottom cards alone order the stacks
+			std::array<size_t, centralCount> keys;
+			std::array<size_t, centralCount> order;
+			auto centralIndices = Game::centralStacksIndices();
+			for (size_t i = 0; i < centralCount; ++i)
+			{
+				const CardStack& stack = game.stack(centralIndices[i]);
+				keys[i] = stack.size() == 0 ? emptyStackKey : mappedId(stack.cards().front(), map);
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+			for (size_t i : order)
+			{
+				const CardStack& stack = game.stack(centralIndices[i]);
+				std::optional<size_t> firstOpen = stack.firstOpenCard();
+				out.write(stack.size(), stackSizeBits);
+				out.write(firstOpen ? *firstOpen : stack.size(), stackSizeBits);
+				for (const Card& card : stack.cards())
+					out.write(mappedId(card, map), cardBits);
+			}
+			return packed;
+		}
+	}
+
+	size_t PackedGame::hash() const
+	{
+		uint64_t h = 0;
+		for (uint64_t word : words)
+		{
+			h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 29;
+		}
+		return static_cast<size_t>(h);
+	}
+
+	PackedGame PackedGame::encode(const Game& game, bool suitSymmetry)
+	{
+		PackedGame best = encodeMapped(game, suitMaps[0]);
+		if (!suitSymmetry)
+			return best;
+
+		for (size_t i = 1; i < suitMaps.size(); ++i)
+			best = std::min(best, encodeMapped(game, suitMaps[i]));
+		return best;
+	}
+
+	std::optional<Game> PackedGame::decode() const
+	{
+		BitReader in(words);
+		CardSet seen = 0;
+		auto nextCard = [&in, &seen](Card::State state) -> std::optional<Card> {
+			size_t id = static_cast<size_t>(in.read(cardBits));
+			if (id >= cardCount || (seen & (CardSet(1) << id)) != 0)
+				return std::nullopt;
+			seen |= CardSet(1) << id;
+			Card card = cardFromId(id);
+			card.state = state;
+			return card;
+		};
+
+		size_t drawCount = in.read(1) ? 3 : 1;
+		size_t openSize = static_cast<size_t>(in.read(stockSizeBits));
+		size_t stockSize = static_cast<size_t>(in.read(stockSizeBits));
+		if (openSize > stockSize)
+			return std::nullopt;
+
+		std::array<CardStack, 4> endStack;
+		for (size_t suit = 0; suit < 4; ++suit)
+		{
+			int height = static_cast<int>(in.read(endHeightBits));
+			if (height > 13)
+				return std::nullopt;
+			std::pmr::vector<Card> cards;
+			for (int number = 1; number <= height; ++number)
+			{
+				cards.emplace_back(number, static_cast<Card::Suit>(suit), Card::State::Open);
+				seen |= cardBit(cards.back());
+			}
+			endStack[suit] = CardStack(std::move(cards));
+		}
+
+		// the buffer holds the open cards bottom first, then the closed cards in draw order, the closed stack has the next card on top
+		std::pmr::vector<Card> openCards;
+		std::pmr::vector<Card> closedCards(stockSize - openSize);
+		for (size_t i = 0; i < stockSize; ++i)
+		{
+			std::optional<Card> card = nextCard(i < openSize ? Card::State::Open : Card::State::Closed);
+			if (!card)
+				return std::nullopt;
+			if (i < openSize)
+				openCards.push_back(*card);
+			else
+				closedCards[stockSize - 1 - i] = *card;
+		}
+
+		std::array<CardStack, centralCount> centralStack;
+		for (CardStack& stack : centralStack)
+		{
+			size_t size = static_cast<size_t>(in.read(stackSizeBits));
+			size_t closed = static_cast<size_t>(in.read(stackSizeBits));
+			if (closed > size)
+				return std::nullopt;
+			std::pmr::vector<Card> cards;
+			cards.reserve(size);
+			for (size_t i = 0; i < size; ++i)
+			{
+				std::optional<Card> card = nextCard(i < closed ? Card::State::Closed : Card::State::Open);
+				if (!card)
+					return std::nullopt;
+				cards.push_back(*card);
+			}
+			stack = CardStack(std::move(cards));
+		}
+
+		if (seen != lowBits(cardCount))
+			return std::nullopt;
+
+		Game game(Game::Stacks(std::move(endStack), std::move(centralStack), CardStack(std::move(closedCards)), CardStack(std::move(openCards))));
+		game.setDrawCount(drawCount);
+		game.checkWin();
+		game.checkLose();
+		return game;
+	}
+}
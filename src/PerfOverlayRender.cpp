@@ -0,0 +1,32 @@
+#include "PerfOverlayRender.h"
+
+#include "Console.h"
+#include "FrameStats.h"
+
+#include <cstdio>
+
+namespace panda
+{
+	PerfOverlayRender::PerfOverlayRender(const FrameStats& frameStats, int x, Console& console)
+		: m_x(x)
+		, m_frameStats(frameStats)
+		, m_console(console)
+	{
+	}
+
+	void PerfOverlayRender::update()
+	{
+		ConsoleStats stats = m_console.stats();
+
+		char lines[4][64];
+		std::snprintf(lines[0], sizeof(lines[0]), " frame %6.2f ms", m_frameStats.last());
+		std::snprintf(lines[1], sizeof(lines[1]), " p99   %6.2f ms", m_frameStats.percentile(0.99));
+		std::snprintf(lines[2], sizeof(lines[2]), " cells %6zu bytes %6zu", stats.cellsWritten, stats.bytesFlushed);
+		std::snprintf(lines[3], sizeof(lines[3]), " input %6zu", stats.inputQueueDepth);
+
+		m_console.setDrawColor(m_textColorFg, m_textColorBg);
+		m_console.drawRect(m_x, m_y, m_width, 4);
+		for (int i = 0; i < 4; ++i)
+			m_console.draw(lines[i], m_x, m_y + i);
+	}
+}
@@ -0,0 +1,83 @@
+#include "Policy.h"
+
+namespace panda
+{
+	std::optional<Move> RandomPolicy::choose(const Game& game, std::mt19937& rng)
+	{
+		std::vector<Move> moves = game.legalMoves();
+		if (moves.empty())
+			return {};
+
+		std::uniform_int_distribution<size_t> pick(0, moves.size() - 1);
+		return moves[pick(rng)];
+	}
+
+	void GreedyPolicy::reset() { m_drawsWithoutProgress = 0; }
+
+	std::optional<Move> GreedyPolicy::choose(const Game& game, std::mt19937&)
+	{
+		std::vector<Move> moves = Solver::candidateMoves(game);
+		if (moves.empty())
+			return {};
+
+		// candidates are sorted by priority, drawing always comes last
+		const Move& move = moves.front();
+		if (move.type != Move::Type::Draw)
+		{
+			m_drawsWithoutProgress = 0;
+			return move;
+		}
+
+		// a whole pass over the closed and open stacks without progress, there is nothing left to try
+		size_t passLength = game.stock().size();
+		if (m_drawsWithoutProgress > passLength)
+			return {};
+
+		++m_drawsWithoutProgress;
+		return move;
+	}
+
+	SolverPolicy::SolverPolicy(Solver::Limits limits)
+		: m_solver(limits)
+	{
+	}
+
+	void SolverPolicy::reset()
+	{
+		m_fallback.reset();
+		m_plan.clear();
+		m_planIndex = 0;
+		m_searched = false;
+	}
+
+	std::optional<Move> SolverPolicy::choose(const Game& game, std::mt19937& rng)
+	{
+		// search once per game, the solver is too expensive to run on every move
+		if (!m_searched)
+		{
+			m_searched = true;
+			Solver::Solution solution = m_solver.solve(game);
+			if (solution.result == Solver::Result::Solved)
+			{
+				m_plan = std::move(solution.moves);
+				m_planIndex = 0;
+			}
+		}
+
+		if (m_planIndex < m_plan.size())
+			return m_plan[m_planIndex++];
+
+		return m_fallback.choose(game, rng);
+	}
+
+	std::unique_ptr<Policy> createPolicy(const std::string& name)
+	{
+		if (name == "random")
+			return std::make_unique<RandomPolicy>();
+		if (name == "greedy")
+			return std::make_unique<GreedyPolicy>();
+		if (name == "solver")
+			return std::make_unique<SolverPolicy>();
+		return nullptr;
+	}
+}
@@ -0,0 +1,118 @@
+#include "Profiler.h"
+
+#ifdef SOLITERMINAL_PROFILING
+
+#	include <atomic>
+#	include <fstream>
+#	include <iomanip>
+#	include <memory>
+#	include <mutex>
+#	include <vector>
+
+namespace panda
+{
+	namespace Profiler
+	{
+		namespace
+		{
+			struct Event
+			{
+				const char* name;
+				int64_t start;
+				int64_t value;    // duration for scopes, value for counters
+				bool counter;
+			};
+
+			// Events of one thread, written without locking by its owner
+			// Once full, further events are dropped instead of growing in the middle of a frame
+			struct ThreadBuffer
+			{
+				static const size_t capacity = 1 << 16;
+
+				explicit ThreadBuffer(size_t id)
+					: id(id)
+					, events(capacity)
+				{
+				}
+
+				size_t id;
+				std::vector<Event> events;
+				std::atomic<size_t> count{0};
+			};
+
+			std::mutex buffersMutex;
+			std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+			const int64_t startTime = now();
+
+			ThreadBuffer& threadBuffer()
+			{
+				thread_local ThreadBuffer* buffer = [] {
+					std::lock_guard<std::mutex> lock(buffersMutex);
+					buffers.push_back(std::make_unique<ThreadBuffer>(buffers.size()));
+					return buffers.back().get();
+				}();
+				return *buffer;
+			}
+
+			void record(const Event& event)
+			{
+				ThreadBuffer& buffer = threadBuffer();
+				size_t index = buffer.count.load(std::memory_order_relaxed);
+				if (index >= ThreadBuffer::capacity)
+					return;
+				buffer.events[index] = event;
+				buffer.count.store(index + 1, std::memory_order_release);
+			}
+		}
+
+		void recordScope(const char* name, int64_t start, int64_t end) { record(Event{name, start, end - start, false}); }
+
+		void recordCounter(const char* name, int64_t value) { record(Event{name, now(), value, true}); }
+
+		bool writeTrace(const std::filesystem::path& path)
+		{
+			std::ofstream file(path);
+			if (!file.is_open())
+				return false;
+
+			// trace timestamps are in microseconds
+			auto micros = [](int64_t nanos) { return static_cast<double>(nanos) / 1000.0; };
+
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			file << std::fixed << std::setprecision(3);
+			file << "{\"traceEvents\":[";
+			bool first = true;
+			for (const auto& buffer : buffers)
+			{
+				size_t count = buffer->count.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const Event& event = buffer->events[i];
+					file << (first ? "\n" : ",\n");
+					first = false;
+					if (event.counter)
+					{
+						file << "{\"name\":\"" << event.name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":" << buffer->id
+							 << ",\"ts\":" << micros(event.start - startTime) << ",\"args\":{\"value\":" << event.value << "}}";
+					}
+					else
+					{
+						file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+							 << ",\"ts\":" << micros(event.start - startTime) << ",\"dur\":" << micros(event.value) << "}";
+					}
+				}
+			}
+			file << "\n]}\n";
+			return true;
+		}
+
+		void clear()
+		{
+			std::lock_guard<std::mutex> lock(buffersMutex);
+			for (const auto& buffer : buffers)
+				buffer->count.store(0, std::memory_order_release);
+		}
+	}
+}
+
+#endif
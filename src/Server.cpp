@@ -0,0 +1,620 @@
+#include "Server.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <system_error>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace panda
+{
+	namespace
+	{
+		// How often sessions waiting for a hint are checked, as the terminal game does
+		const int hintPollMilliseconds = 50;
+		const size_t readBufferSize = 4096;
+		const size_t maxWriteVectors = 64;    // frames handed to one sendmsg call
+		const size_t maxListedGames = 20;     // session ids shown at the spectator prompt
+
+		// spectator input, the prompt takes digits and a viewer leaves with q or the keys that end a session
+		const char keyCtrlC = 3;
+		const char keyCtrlD = 4;
+
+		[[noreturn]] void throwError(const char* context) { throw std::system_error(errno, std::generic_category(), context); }
+
+		// thousands of sessions need as many descriptors, raise the soft limit as far as allowed
+		void raiseDescriptorLimit()
+		{
+			rlimit limit;
+			if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+			{
+				limit.rlim_cur = limit.rlim_max;
+				setrlimit(RLIMIT_NOFILE, &limit);
+			}
+		}
+	}
+
+	Server::Server(Config config)
+		: m_config(std::move(config))
+		, m_nextSeed(std::random_device()())
+		, m_nextReport(std::chrono::steady_clock::now() + m_config.reportInterval)
+	{
+		raiseDescriptorLimit();
+
+		m_epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (m_epoll < 0)
+			throwError("epoll_create1");
+		m_wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (m_wake < 0)
+			throwError("eventfd");
+		watch(m_wake, EPOLLIN);
+
+		if (m_config.port != 0)
+			m_listeners.push_back(listenTcp(m_config.port));
+		if (!m_config.unixPath.empty())
+			listenUnix();
+		if (m_listeners.empty())
+			throw std::runtime_error("No port or Unix socket to listen on");
+		if (m_config.watchPort != 0)
+			m_watchListener = listenTcp(m_config.watchPort);
+	}
+
+	Server::~Server()
+	{
+		for (auto& entry : m_connections)
+			::close(entry.first);
+		for (auto& entry : m_viewers)
+			::close(entry.first);
+		for (int fd : m_listeners)
+			::close(fd);
+		if (m_watchListener >= 0)
+			::close(m_watchListener);
+		if (!m_config.unixPath.empty())
+			unlink(m_config.unixPath.c_str());
+		if (m_wake >= 0)
+			::close(m_wake);
+		if (m_epoll >= 0)
+			::close(m_epoll);
+	}
+
+	void Server::run()
+	{
+		std::vector<epoll_event> events(256);
+		while (!m_stop)
+		{
+			int count = epoll_wait(m_epoll, events.data(), static_cast<int>(events.size()), timeout());
+			if (count < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				throwError("epoll_wait");
+			}
+
+			for (int i = 0; i < count; ++i)
+			{
+				int fd = events[i].data.fd;
+				uint32_t flags = events[i].events;
+				if (fd == m_wake)
+					continue;
+				if (std::find(m_listeners.begin(), m_listeners.end(), fd) != m_listeners.end())
+				{
+					accept(fd);
+					continue;
+				}
+				if (fd == m_watchListener)
+				{
+					acceptViewer(fd);
+					continue;
+				}
+
+				// an earlier event of this round may have closed it
+				auto viewerIt = m_viewers.find(fd);
+				if (viewerIt != m_viewers.end())
+				{
+					if (flags & (EPOLLERR | EPOLLHUP))
+						closeViewer(fd);
+					else if (flags & (EPOLLIN | EPOLLRDHUP))
+						readViewer(viewerIt->second);
+					else if (flags & EPOLLOUT)
+						flushViewer(viewerIt->second);
+					continue;
+				}
+				auto it = m_connections.find(fd);
+				if (it == m_connections.end())
+					continue;
+				if (flags & (EPOLLERR | EPOLLHUP))
+				{
+					close(fd);
+					continue;
+				}
+				// a failing session is closed, the other players keep going
+				try
+				{
+					if (flags & (EPOLLIN | EPOLLRDHUP))
+						read(it->second);
+					else if (flags & EPOLLOUT)
+						flush(it->second);
+				}
+				catch (const std::exception&)
+				{
+					if (m_connections.count(fd) != 0)
+						close(fd);
+				}
+			}
+			updateHints();
+
+			if (m_config.report && m_config.reportInterval.count() > 0 && std::chrono::steady_clock::now() >= m_nextReport)
+			{
+				updateSessionStats();
+				m_config.report(m_stats);
+				m_nextReport = std::chrono::steady_clock::now() + m_config.reportInterval;
+			}
+		}
+	}
+
+	void Server::stop()
+	{
+		m_stop = true;
+		uint64_t one = 1;
+		[[maybe_unused]] ssize_t written = write(m_wake, &one, sizeof(one));
+	}
+
+	int Server::listenTcp(uint16_t port)
+	{
+		int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			throwError("socket");
+		int yes = 1;
+		setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+		// loopback only, the server has no authentication
+		sockaddr_in address{};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0)
+		{
+			::close(fd);
+			throwError("bind TCP port");
+		}
+		watch(fd, EPOLLIN);
+		return fd;
+	}
+
+	void Server::listenUnix()
+	{
+		sockaddr_un address{};
+		if (m_config.unixPath.size() >= sizeof(address.sun_path))
+			throw std::runtime_error("Unix socket path is too long");
+
+		int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if (fd < 0)
+			throwError("socket");
+		address.sun_family = AF_UNIX;
+		std::copy(m_config.unixPath.begin(), m_config.unixPath.end(), address.sun_path);
+		unlink(m_config.unixPath.c_str());
+		if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0)
+		{
+			::close(fd);
+			throwError("bind Unix socket");
+		}
+		m_listeners.push_back(fd);
+		watch(fd, EPOLLIN);
+	}
+
+	void Server::watch(int fd, uint32_t events)
+	{
+		epoll_event event{};
+		event.events = events;
+		event.data.fd = fd;
+		if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) < 0)
+			throwError("epoll_ctl");
+	}
+
+	void Server::accept(int listenFd)
+	{
+		while (true)
+		{
+			int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0)
+				return;    // EAGAIN once the backlog is empty, other errors are left to the next round
+
+			if (m_connections.size() >= m_config.maxSessions)
+			{
+				::close(fd);
+				continue;
+			}
+
+			// frames are small and sent as soon as they are drawn
+			int yes = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+			Connection& connection = m_connections[fd];
+			connection.fd = fd;
+			connection.id = m_nextId++;
+			m_sessionIds[connection.id] = fd;
+			connection.session = std::make_unique<Session>(m_hints, m_nextSeed++, m_config.width, m_config.height);
+			watch(fd, EPOLLIN | EPOLLRDHUP);
+
+			m_stats.accepted++;
+			m_stats.sessions = m_connections.size();
+			m_stats.peakSessions = std::max(m_stats.peakSessions, m_stats.sessions);
+
+			std::string greeting = Session::greeting();
+			[[maybe_unused]] ssize_t written = send(fd, greeting.data(), greeting.size(), MSG_NOSIGNAL);
+			flush(connection);
+		}
+	}
+
+	void Server::read(Connection& connection)
+	{
+		PANDA_PROFILE_SCOPE("Server::read");
+		size_t outputStart = connection.session->output().size();
+		char buffer[readBufferSize];
+		while (true)
+		{
+			ssize_t count = recv(connection.fd, buffer, sizeof(buffer), 0);
+			if (count > 0)
+			{
+				m_stats.bytesReceived += static_cast<size_t>(count);
+				connection.session->receive(buffer, static_cast<size_t>(count));
+				if (static_cast<size_t>(count) < sizeof(buffer))
+					break;
+				continue;
+			}
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				break;
+			if (count < 0 && errno == EINTR)
+				continue;
+			close(connection.fd);    // orderly shutdown or a reset
+			return;
+		}
+
+		if (connection.session->hintPending())
+			m_hintWaiters.push_back(connection.fd);
+		broadcast(connection, outputStart);
+		flush(connection);
+	}
+
+	void Server::flush(Connection& connection)
+	{
+		Session& session = *connection.session;
+		while (!session.output().empty())
+		{
+			ssize_t count = send(connection.fd, session.output().data(), session.output().size(), MSG_NOSIGNAL);
+			if (count > 0)
+			{
+				m_stats.bytesSent += static_cast<size_t>(count);
+				session.consume(static_cast<size_t>(count));
+				continue;
+			}
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				break;
+			close(connection.fd);
+			return;
+		}
+
+		// a client that stops reading is dropped rather than buffered for without limit
+		if (session.output().size() > m_config.maxPendingBytes)
+		{
+			close(connection.fd);
+			return;
+		}
+		if (session.output().empty() && session.closed())
+		{
+			close(connection.fd);
+			return;
+		}
+
+		bool wantWrite = !session.output().empty();
+		if (wantWrite != connection.writeWatched)
+		{
+			epoll_event event{};
+			event.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0u);
+			event.data.fd = connection.fd;
+			epoll_ctl(m_epoll, EPOLL_CTL_MOD, connection.fd, &event);
+			connection.writeWatched = wantWrite;
+		}
+	}
+
+	void Server::close(int fd)
+	{
+		auto it = m_connections.find(fd);
+		if (it != m_connections.end())
+		{
+			// the spectators have nothing left to watch
+			std::vector<int> viewers = std::move(it->second.viewers);
+			for (int viewer : viewers)
+				closeViewer(viewer);
+			m_sessionIds.erase(it->second.id);
+		}
+
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+		::close(fd);
+		m_connections.erase(fd);
+		m_stats.sessions = m_connections.size();
+	}
+
+	void Server::acceptViewer(int listenFd)
+	{
+		while (true)
+		{
+			int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+			if (fd < 0)
+				return;
+
+			if (m_viewers.size() >= m_config.maxViewers)
+			{
+				::close(fd);
+				continue;
+			}
+
+			int yes = 1;
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+
+			Viewer& viewer = m_viewers[fd];
+			viewer.fd = fd;
+			watch(fd, EPOLLIN | EPOLLRDHUP);
+			m_stats.viewers = m_viewers.size();
+			m_stats.peakViewers = std::max(m_stats.peakViewers, m_stats.viewers);
+
+			std::string message = Session::greeting() + "Soliterminal spectator mode, q leaves\r\nGames:";
+			size_t listed = 0;
+			for (auto it = m_sessionIds.begin(); it != m_sessionIds.end() && listed < maxListedGames; ++it, ++listed)
+				message += " " + std::to_string(it->first);
+			if (m_sessionIds.empty())
+				message += " none yet";
+			prompt(viewer, message + "\r\nGame to watch, Enter for the first: ");
+		}
+	}
+
+	void Server::broadcast(Connection& connection, size_t outputStart)
+	{
+		const auto& output = connection.session->output();
+		if (output.size() <= outputStart)
+			return;
+
+		// the keyframe is behind the screen now
+		connection.keyframe.reset();
+		if (connection.viewers.empty())
+			return;
+
+		PANDA_PROFILE_SCOPE("Server::broadcast");
+		Frame frame = std::make_shared<const std::string>(output.data() + outputStart, output.size() - outputStart);
+		m_stats.framesBroadcast++;
+		std::vector<int> viewers = connection.viewers;    // a viewer that fails is closed while queueing
+		for (int fd : viewers)
+		{
+			auto it = m_viewers.find(fd);
+			if (it != m_viewers.end())
+				queue(it->second, frame);
+		}
+	}
+
+	Server::Frame Server::keyframe(Connection& connection)
+	{
+		if (!connection.keyframe)
+			connection.keyframe = std::make_shared<const std::string>(connection.session->keyframe());
+		return connection.keyframe;
+	}
+
+	void Server::queue(Viewer& viewer, Frame frame)
+	{
+		if (viewer.pending + frame->size() > m_config.maxViewerBytes)
+		{
+			// a viewer that fell behind skips the frames it has not seen, the latest keyframe redraws the screen as it is now
+			auto player = m_connections.find(viewer.player);
+			if (player == m_connections.end())
+				return;
+			size_t keep = viewer.offset > 0 ? 1 : 0;    // a frame sent in part has to be finished first
+			viewer.frames.resize(keep);
+			viewer.pending = keep > 0 ? viewer.frames.front()->size() - viewer.offset : 0;
+			frame = keyframe(player->second);
+			m_stats.viewerSkips++;
+		}
+		viewer.pending += frame->size();
+		viewer.frames.push_back(std::move(frame));
+		flushViewer(viewer);
+	}
+
+	void Server::prompt(Viewer& viewer, const std::string& message)
+	{
+		queue(viewer, std::make_shared<const std::string>(message));
+	}
+
+	void Server::readViewer(Viewer& viewer)
+	{
+		char buffer[readBufferSize];
+		while (true)
+		{
+			ssize_t count = recv(viewer.fd, buffer, sizeof(buffer), 0);
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				return;
+			if (count <= 0)
+			{
+				closeViewer(viewer.fd);
+				return;
+			}
+			m_stats.bytesReceived += static_cast<size_t>(count);
+
+			int fd = viewer.fd;
+			size_t position = 0;
+			while (std::optional<TelnetInput::Key> key = viewer.input.next(buffer, static_cast<size_t>(count), position))
+			{
+				// escape sequences such as the arrow keys mean nothing to a viewer
+				if (key->type != TelnetInput::Key::Type::Char)
+					continue;
+				char c = key->c;
+				if (c == 'q' || c == keyCtrlC || c == keyCtrlD)
+				{
+					closeViewer(fd);
+					return;
+				}
+				if (viewer.player >= 0)
+					continue;
+				if (c >= '0' && c <= '9' && viewer.choice.size() < 9)
+				{
+					viewer.choice += c;
+					prompt(viewer, std::string(1, c));
+				}
+				else if (c == '\r' || c == '\n')
+				{
+					attach(viewer);
+				}
+				if (m_viewers.find(fd) == m_viewers.end())
+					return;
+			}
+			viewer.input.finish();    // a lone escape is no key of a viewer either
+		}
+	}
+
+	void Server::attach(Viewer& viewer)
+	{
+		auto id = viewer.choice.empty() ? m_sessionIds.begin() : m_sessionIds.find(static_cast<uint32_t>(std::stoul(viewer.choice)));
+		viewer.choice.clear();
+		if (id == m_sessionIds.end())
+		{
+			prompt(viewer, "\r\nNo such game, pick another: ");
+			return;
+		}
+
+		Connection& connection = m_connections[id->second];
+		viewer.player = connection.fd;
+		connection.viewers.push_back(viewer.fd);
+		queue(viewer, keyframe(connection));
+	}
+
+	void Server::flushViewer(Viewer& viewer)
+	{
+		PANDA_PROFILE_SCOPE("Server::flushViewer");
+		while (!viewer.frames.empty())
+		{
+			// the queued frames go out in one call, the buffers are shared and never copied
+			iovec vectors[maxWriteVectors];
+			size_t count = 0;
+			for (auto it = viewer.frames.begin(); it != viewer.frames.end() && count < maxWriteVectors; ++it, ++count)
+			{
+				size_t skip = count == 0 ? viewer.offset : 0;
+				vectors[count].iov_base = const_cast<char*>((*it)->data() + skip);
+				vectors[count].iov_len = (*it)->size() - skip;
+			}
+			msghdr message{};
+			message.msg_iov = vectors;
+			message.msg_iovlen = count;
+			ssize_t sent = sendmsg(viewer.fd, &message, MSG_NOSIGNAL);
+			if (sent < 0 && errno == EINTR)
+				continue;
+			if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				break;
+			if (sent <= 0)
+			{
+				closeViewer(viewer.fd);
+				return;
+			}
+
+			size_t bytes = static_cast<size_t>(sent);
+			m_stats.bytesBroadcast += bytes;
+			viewer.pending -= bytes;
+			bytes += viewer.offset;
+			while (!viewer.frames.empty() && bytes >= viewer.frames.front()->size())
+			{
+				bytes -= viewer.frames.front()->size();
+				viewer.frames.pop_front();
+			}
+			viewer.offset = bytes;
+		}
+
+		bool wantWrite = !viewer.frames.empty();
+		if (wantWrite != viewer.writeWatched)
+		{
+			epoll_event event{};
+			event.events = EPOLLIN | EPOLLRDHUP | (wantWrite ? EPOLLOUT : 0u);
+			event.data.fd = viewer.fd;
+			epoll_ctl(m_epoll, EPOLL_CTL_MOD, viewer.fd, &event);
+			viewer.writeWatched = wantWrite;
+		}
+	}
+
+	void Server::closeViewer(int fd)
+	{
+		auto it = m_viewers.find(fd);
+		if (it == m_viewers.end())
+			return;
+
+		auto player = m_connections.find(it->second.player);
+		if (player != m_connections.end())
+		{
+			auto& viewers = player->second.viewers;
+			viewers.erase(std::remove(viewers.begin(), viewers.end(), fd), viewers.end());
+		}
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, fd, nullptr);
+		::close(fd);
+		m_viewers.erase(it);
+		m_stats.viewers = m_viewers.size();
+	}
+
+	int Server::timeout() const
+	{
+		int timeout = m_hintWaiters.empty() ? -1 : hintPollMilliseconds;
+		if (m_config.report && m_config.reportInterval.count() > 0)
+		{
+			auto untilReport = std::chrono::duration_cast<std::chrono::milliseconds>(m_nextReport - std::chrono::steady_clock::now()).count();
+			int reportTimeout = static_cast<int>(std::max<long long>(0, untilReport));
+			timeout = timeout < 0 ? reportTimeout : std::min(timeout, reportTimeout);
+		}
+		return timeout;
+	}
+
+	void Server::updateSessionStats()
+	{
+		m_stats.activeSessions = 0;
+		m_stats.arenaBytes = 0;
+		m_stats.overflowBytes = 0;
+		for (const auto& entry : m_connections)
+		{
+			m_stats.activeSessions += entry.second.session->playing() ? 1 : 0;
+			m_stats.arenaBytes += entry.second.session->arenaBytes();
+			m_stats.overflowBytes += entry.second.session->overflowBytes();
+		}
+	}
+
+	void Server::updateHints()
+	{
+		if (m_hintWaiters.empty())
+			return;
+
+		// duplicates and closed connections are dropped here, sessions still waiting stay in the list
+		std::sort(m_hintWaiters.begin(), m_hintWaiters.end());
+		m_hintWaiters.erase(std::unique(m_hintWaiters.begin(), m_hintWaiters.end()), m_hintWaiters.end());
+		std::vector<int> waiting;
+		for (int fd : m_hintWaiters)
+		{
+			auto it = m_connections.find(fd);
+			if (it == m_connections.end())
+				continue;
+			size_t outputStart = it->second.session->output().size();
+			if (it->second.session->updateHint())
+				waiting.push_back(fd);
+			broadcast(it->second, outputStart);
+			flush(it->second);
+		}
+		m_hintWaiters = std::move(waiting);
+	}
+}
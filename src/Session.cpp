@@ -0,0 +1,136 @@
+#include "Session.h"
+
+#include "HintEngine.h"
+#include "Profiler.h"
+
+#include <chrono>
+
+namespace panda
+{
+	namespace
+	{
+		// telnet command bytes, RFC 854
+		const unsigned char IAC = 255;
+		const unsigned char WILL = 251;
+		const unsigned char ECHO = 1;
+		const unsigned char SUPPRESS_GO_AHEAD = 3;
+
+		const char KEY_CTRL_C = 3;
+		const char KEY_CTRL_D = 4;
+
+		Action toAction(char c)
+		{
+			if (c == ' ' || c == '\r')
+				return Action::Use;
+			if (c == 'p')
+				return Action::ToggleOverlay;
+			if (c == 'h')
+				return Action::Hint;
+			return Action::None;
+		}
+
+		Action arrowAction(char c)
+		{
+			if (c == 'A')
+				return Action::Up;
+			if (c == 'B')
+				return Action::Down;
+			if (c == 'C')
+				return Action::Right;
+			if (c == 'D')
+				return Action::Left;
+			return Action::None;
+		}
+	}
+
+	Session::Session(HintEngine& hints, unsigned int seed, int width, int height)
+		: m_arena(m_arenaBuffer.data(), m_arenaBuffer.size())
+		, m_game(Game::createRandomGame(seed), &m_arena)
+		, m_layout(createGameLayout(), &m_arena)
+		, m_gameControl(m_game, m_layout, hints)
+		, m_menu{"Soliterminal",
+				 "",
+				 {{"Resume", [this]() { m_app.setState(App::State::Game); }},
+				  {"New Game",
+				   [this]() {
+					   // the next deal follows from the current position, every session gets its own sequence
+					   m_game.reset(Game::createRandomGame(static_cast<unsigned int>(m_game.hash())));
+					   m_gameControl.reset();
+					   m_app.setState(App::State::Game);
+				   }},
+				  {"Toggle auto play", [this]() { m_game.setAutoPlay(!m_game.autoPlay()); }},
+				  {"Toggle draw one or three", [this]() { m_game.setDrawCount(m_game.drawCount() == 3 ? 1 : 3); }},
+				  {"Exit", [this]() { m_app.setState(App::State::Exit); }}},
+				 &m_arena}
+		, m_menuControl(m_menu, &m_arena)
+		, m_console(width, height, &m_arena)
+		, m_gameRender(m_game, m_gameControl.selection(), m_layout, m_console)
+		, m_menuRender(m_menu, m_menuControl.selection(), m_console)
+		, m_overlayRender(m_frameStats, m_gameRender.right(), m_console)
+		, m_appControl(m_app, AppControl::Controls{m_gameControl, m_menuControl})
+		, m_appRender(m_app, AppRender::Renders{m_gameRender, m_menuRender, m_overlayRender}, m_console)
+	{
+		m_game.setDrawCount(3);
+		m_game.setAutoPlay(true);
+		m_appRender.update();
+	}
+
+	const std::string& Session::greeting()
+	{
+		static const std::string bytes{static_cast<char>(IAC), static_cast<char>(WILL), static_cast<char>(ECHO),
+									   static_cast<char>(IAC), static_cast<char>(WILL), static_cast<char>(SUPPRESS_GO_AHEAD)};
+		return bytes;
+	}
+
+	void Session::receive(const char* data, size_t size)
+	{
+		PANDA_PROFILE_SCOPE("Session::receive");
+		size_t position = 0;
+		while (!closed())
+		{
+			std::optional<TelnetInput::Key> key = m_input.next(data, size, position);
+			if (!key)
+				break;
+			if (key->type == TelnetInput::Key::Type::Escape)
+				action(Action::Exit);    // a lone escape opens the menu
+			else if (key->type == TelnetInput::Key::Type::Sequence)
+				action(arrowAction(key->c));
+			else if (key->c == KEY_CTRL_C || key->c == KEY_CTRL_D)
+				m_app.setState(App::State::Exit);
+			else
+				action(toAction(key->c));
+		}
+
+		if (m_input.finish())
+			action(Action::Exit);
+	}
+
+	bool Session::updateHint()
+	{
+		if (!m_gameControl.hintPending())
+			return false;
+		action(Action::None);
+		return m_gameControl.hintPending();
+	}
+
+	void Session::action(Action action)
+	{
+		if (action == Action::None && !m_gameControl.hintPending())
+			return;
+
+		auto frameStart = std::chrono::steady_clock::now();
+		App::State previousState = m_app.state();
+		m_appControl.action(action);
+		if (closed())
+			return;
+		if (m_app.state() == App::State::Pause && previousState != App::State::Pause)
+			m_menu.setText(m_game.state() == Game::State::Lose ? "The game is lost, no move can change it" : "");
+
+		// the end of a decided game is played at once, a frame diff carries all the moved cards
+		if (m_app.state() == App::State::Game && m_game.canAutoComplete())
+			m_game.autoComplete();
+
+		m_appRender.update();
+		m_frameStats.addFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+	}
+}
@@ -0,0 +1,155 @@
+#include "Simulation.h"
+
+#include "FreeCellSolver.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace panda
+{
+	namespace Simulation
+	{
+		size_t Report::wins() const
+		{
+			return std::count_if(results.begin(), results.end(), [](const GameResult& result) { return result.won; });
+		}
+
+		double Report::winRate() const { return results.empty() ? 0.0 : static_cast<double>(wins()) / results.size(); }
+
+		double Report::averageMoves() const
+		{
+			if (results.empty())
+				return 0.0;
+			double total = 0.0;
+			for (const GameResult& result : results)
+				total += static_cast<double>(result.moves);
+			return total / results.size();
+		}
+
+		double Report::averageMicroseconds() const
+		{
+			if (results.empty())
+				return 0.0;
+			double total = 0.0;
+			for (const GameResult& result : results)
+				total += result.microseconds;
+			return total / results.size();
+		}
+
+		double Report::gamesPerSecond() const { return wallSeconds > 0.0 ? results.size() / wallSeconds : 0.0; }
+
+		double Report::totalSeconds() const { return averageMicroseconds() * results.size() / 1e6; }
+
+		size_t playOut(Game& game, Policy& policy, std::mt19937& rng, size_t maxMoves)
+		{
+			size_t moves = 0;
+			policy.reset();
+			while (game.state() == Game::State::Playing && moves < maxMoves)
+			{
+				if (game.canAutoComplete())
+				{
+					moves += game.autoComplete().size();
+					break;
+				}
+
+				std::optional<Move> move = policy.choose(game, rng);
+				if (!move || !game.applyMove(*move))
+					break;
+				++moves;
+			}
+			return moves;
+		}
+
+		GameResult playGame(unsigned int seed, Policy& policy, const Config& config)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			GameResult result;
+			result.seed = seed;
+
+			Game game = Game::createRandomGame(seed);
+			game.setDrawCount(config.drawCount);
+			game.setAutoPlay(config.autoPlay);
+			std::mt19937 rng(seed);
+			result.moves = playOut(game, policy, rng, config.maxMoves);
+			result.won = game.state() == Game::State::Win;
+
+			auto elapsed = std::chrono::steady_clock::now() - start;
+			result.microseconds = std::chrono::duration<double, std::micro>(elapsed).count();
+			return result;
+		}
+
+		Report run(const Config& config)
+		{
+			if (!createPolicy(config.policy))
+				throw std::invalid_argument("Unknown policy: " + config.policy);
+
+			ThreadPool pool(config.threads);
+
+			Report report;
+			report.policy = config.policy;
+			report.threads = pool.size();
+			report.results.resize(config.games);
+
+			// a few shards per thread keeps workers busy when some games take longer than others
+			size_t shards = std::min(config.games, pool.size() * 8);
+			size_t shardSize = shards == 0 ? 0 : (config.games + shards - 1) / shards;
+
+			auto start = std::chrono::steady_clock::now();
+			for (size_t first = 0; first < config.games; first += shardSize)
+			{
+				size_t last = std::min(first + shardSize, config.games);
+				pool.submit([&config, &report, first, last]() {
+					std::unique_ptr<Policy> policy = createPolicy(config.policy);
+					for (size_t i = first; i < last; ++i)
+						report.results[i] = playGame(config.firstSeed + static_cast<unsigned int>(i), *policy, config);
+				});
+			}
+			pool.wait();
+
+			report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			return report;
+		}
+
+		Report solveFreeCell(const Config& config)
+		{
+			ThreadPool pool(config.threads);
+
+			Report report;
+			report.policy = "freecell";
+			report.threads = pool.size();
+			report.results.resize(config.games);
+
+			size_t shards = std::min(config.games, pool.size() * 8);
+			size_t shardSize = shards == 0 ? 0 : (config.games + shards - 1) / shards;
+
+			auto start = std::chrono::steady_clock::now();
+			for (size_t first = 0; first < config.games; first += shardSize)
+			{
+				size_t last = std::min(first + shardSize, config.games);
+				pool.submit([&config, &report, first, last]() {
+					FreeCellSolver solver;
+					for (size_t i = first; i < last; ++i)
+					{
+						auto gameStart = std::chrono::steady_clock::now();
+						GameResult& result = report.results[i];
+						result.seed = config.firstSeed + static_cast<unsigned int>(i);
+
+						FreeCellSolver::Solution solution = solver.solve(FreeCellGame::createDeal(result.seed));
+						result.won = solution.result == FreeCellSolver::Result::Solved;
+						result.moves = solution.moves.size();
+
+						auto elapsed = std::chrono::steady_clock::now() - gameStart;
+						result.microseconds = std::chrono::duration<double, std::micro>(elapsed).count();
+					}
+				});
+			}
+			pool.wait();
+
+			report.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			return report;
+		}
+	}
+}
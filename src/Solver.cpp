@@ -0,0 +1,156 @@
+#include "Solver.h"
+
+namespace panda
+{
+	namespace
+	{
+		// Returns if the card can be placed on any end stack
+		// the end heights tell the next card of every suit, there is always an empty end stack for a missing ace
+		bool fitsEndStack(const Game& game, const Card& card) { return game.endHeight(card.suit) + 1 == card.number; }
+	}
+
+	Solver::Solver()
+		: Solver(Limits{})
+	{
+	}
+
+	Solver::Solver(Limits limits)
+		: m_limits(limits)
+	{
+	}
+
+	Solver::Solution Solver::solve(const Game& game)
+	{
+		m_visited.clear();
+		m_nodes = 0;
+		m_limitReached = false;
+		m_deadline = std::chrono::steady_clock::now() + m_limits.maxTime;
+
+		Solution solution;
+		bool solved = search(game, solution.moves);
+		solution.nodes = m_nodes;
+		if (solved)
+			solution.result = Result::Solved;
+		else
+			solution.result = m_limitReached ? Result::LimitReached : Result::NotFound;
+
+		if (!solved)
+			solution.moves.clear();
+		return solution;
+	}
+
+	std::vector<Move> Solver::candidateMoves(const Game& game)
+	{
+		std::vector<Move> toEnd;
+		std::vector<Move> exposing;
+		std::vector<Move> fromOpen;
+		std::vector<Move> partial;
+		std::vector<Move> draw;
+
+		for (const Move& move : game.legalMoves())
+		{
+			// flipping is always safe, no need to explore anything else
+			if (move.type == Move::Type::Flip)
+				return {move};
+
+			if (move.type == Move::Type::Draw)
+			{
+				draw.push_back(move);
+				continue;
+			}
+
+			// cards are never taken back from the end stacks
+			if (game.isEndStack(move.sourceStack))
+				continue;
+
+			if (game.isEndStack(move.destStack))
+			{
+				toEnd.push_back(move);
+				continue;
+			}
+
+			if (game.isOpenStack(move.sourceStack))
+			{
+				fromOpen.push_back(move);
+				continue;
+			}
+
+			// central to central moves
+			const CardStack& source = game.stack(move.sourceStack);
+			const CardStack& dest = game.stack(move.destStack);
+			std::optional<size_t> firstOpen = source.firstOpenCard();
+			if (move.sourceCard == *firstOpen)
+			{
+				// moving a whole stack to an empty one changes nothing
+				if (move.sourceCard == 0 && dest.size() == 0)
+					continue;
+				exposing.push_back(move);
+			}
+			else if (fitsEndStack(game, source.cards()[move.sourceCard - 1]))
+			{
+				// splitting an open run is only useful to free the card beneath
+				partial.push_back(move);
+			}
+		}
+
+		std::vector<Move> moves;
+		moves.reserve(toEnd.size() + exposing.size() + fromOpen.size() + partial.size() + draw.size());
+		for (auto* group : {&toEnd, &exposing, &fromOpen, &partial, &draw})
+			moves.insert(moves.end(), group->begin(), group->end());
+		return moves;
+	}
+
+	bool Solver::search(const Game& game, std::vector<Move>& path)
+	{
+		if (game.state() == Game::State::Win)
+			return true;
+
+		// every card is visible and the stock is empty, the rest plays itself
+		if (game.canAutoComplete())
+		{
+			Game next = game;
+			std::vector<Move> moves = next.autoComplete();
+			if (next.state() == Game::State::Win)
+			{
+				path.insert(path.end(), moves.begin(), moves.end());
+				return true;
+			}
+		}
+
+		if (limitReached())
+			return false;
+
+		// skip states that were already explored through another path
+		if (!m_visited.insert(game.hash()).second)
+			return false;
+
+		++m_nodes;
+		for (const Move& move : candidateMoves(game))
+		{
+			Game next = game;
+			if (!next.applyMove(move))
+				continue;
+
+			path.push_back(move);
+			if (search(next, path))
+				return true;
+			path.pop_back();
+
+			if (m_limitReached)
+				return false;
+		}
+		return false;
+	}
+
+	bool Solver::limitReached()
+	{
+		if (m_nodes >= m_limits.maxNodes)
+			m_limitReached = true;
+		else if (m_limits.cancelled && m_limits.cancelled->load(std::memory_order_relaxed))
+			m_limitReached = true;
+		// reading the clock is comparatively slow, only check it every few nodes
+		else if ((m_nodes & 0x3FF) == 0 && std::chrono::steady_clock::now() > m_deadline)
+			m_limitReached = true;
+		return m_limitReached;
+	}
+}
@@ -0,0 +1,274 @@
+#include "SpiderGame.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <random>
+
+namespace panda
+{
+	namespace
+	{
+		// Two decks worth of cards, using only the first suits when playing with fewer than four
+		std::pmr::vector<Card> createDecks(size_t suits)
+		{
+			static const std::array<Card::Suit, 4> suitOrder{Card::Suit::Spade, Card::Suit::Heart, Card::Suit::Club, Card::Suit::Diamond};
+			suits = suits >= 4 ? 4 : (suits >= 2 ? 2 : 1);
+
+			std::pmr::vector<Card> deck;
+			deck.reserve(104);
+			for (size_t copy = 0; copy < 8 / suits; ++copy)
+			{
+				for (size_t suitIndex = 0; suitIndex < suits; ++suitIndex)
+				{
+					for (int number = 1; number <= 13; ++number)
+						deck.emplace_back(number, suitOrder[suitIndex], Card::State::Closed);
+				}
+			}
+			return deck;
+		}
+
+		// Fisher-Yates shuffle driven directly by the engine output, same as the Klondike deals
+		void shuffleDeck(std::pmr::vector<Card>& deck, std::mt19937& g)
+		{
+			for (size_t i = deck.size() - 1; i > 0; --i)
+			{
+				size_t j = static_cast<size_t>(g() % (i + 1));
+				std::swap(deck[i], deck[j]);
+			}
+		}
+
+		// Returns if the card continues the same suit run of the card below it
+		bool continuesRun(const Card& below, const Card& card)
+		{
+			return below.state == Card::State::Open && card.state == Card::State::Open && below.suit == card.suit && below.number == card.number + 1;
+		}
+	}
+
+	SpiderGame::SpiderGame(std::vector<CardStack>&& stacks)
+		: m_stacks(std::move(stacks))
+	{
+		assert(m_stacks.size() == stackCount);
+		m_stacks.resize(stackCount);
+
+		for (size_t stackIndex : centralStacksIndices())
+			updateRuns(stackIndex, 0);
+
+		for (size_t stackIndex = 1; stackIndex < 9; ++stackIndex)
+			m_completedRuns += m_stacks[stackIndex].size() / 13;
+		if (m_completedRuns == 8)
+			m_state = State::Win;
+	}
+
+	SpiderGame SpiderGame::createRandomGame(unsigned int seed, size_t suits)
+	{
+		std::pmr::vector<Card> deck = createDecks(suits);
+		std::mt19937 g(seed);
+		shuffleDeck(deck, g);
+
+		std::vector<CardStack> stacks(stackCount);
+
+		// the first four central stacks get six cards, the rest five, with the top card open
+		size_t column = 0;
+		for (size_t stackIndex : centralStacksIndices())
+		{
+			size_t cardsToTake = column++ < 4 ? 6 : 5;
+			std::pmr::vector<Card> cards(std::make_move_iterator(deck.end() - cardsToTake), std::make_move_iterator(deck.end()));
+			deck.erase(deck.end() - cardsToTake, deck.end());
+
+			CardStack stack(std::move(cards));
+			stack.flipTop();
+			stacks[stackIndex] = std::move(stack);
+		}
+
+		assert(deck.size() == 50);
+		stacks[0] = CardStack(std::move(deck));    // five rows left to deal
+		return SpiderGame(std::move(stacks));
+	}
+
+	bool SpiderGame::canDeal() const
+	{
+		if (m_state != State::Playing || m_stacks[0].size() == 0)
+			return false;
+
+		// a row can only be dealt when every central stack has cards
+		auto indices = centralStacksIndices();
+		return std::none_of(indices.begin(), indices.end(), [this](size_t stackIndex) { return m_stacks[stackIndex].size() == 0; });
+	}
+
+	bool SpiderGame::deal()
+	{
+		if (!canDeal())
+			return false;
+
+		CardStack& closed = m_stacks[0];
+		MoveBuffer buffer;
+		for (size_t stackIndex : centralStacksIndices())
+		{
+			std::optional<CardStack> top = closed.takeTop(&buffer);
+			if (!top)
+				break;
+			top->flipAll();
+
+			CardStack& stack = m_stacks[stackIndex];
+			size_t first = stack.size();
+			stack.append(std::move(*top));
+			updateRuns(stackIndex, first);
+			settle(stackIndex);
+		}
+		return true;
+	}
+
+	bool SpiderGame::canMoveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex) const
+	{
+		if (m_state != State::Playing)
+			return false;
+
+		// runs only move between central stacks
+		if (!isCentralStack(sourceStackIndex) || !isCentralStack(destStackIndex) || sourceStackIndex == destStackIndex)
+			return false;
+
+		const CardStack& source = m_stacks[sourceStackIndex];
+		if (sourceCardIndex >= source.size())
+			return false;
+
+		// the moved cards have to be a single run, known from the run length of the top card
+		if (runLength(sourceStackIndex) < source.size() - sourceCardIndex)
+			return false;
+
+		// any card goes on an empty stack, otherwise on a card one higher of any suit
+		std::optional<Card> destTop = m_stacks[destStackIndex].top();
+		if (!destTop)
+			return true;
+		return destTop->state == Card::State::Open && destTop->number == source.cards()[sourceCardIndex].number + 1;
+	}
+
+	bool SpiderGame::moveCards(size_t sourceStackIndex, size_t sourceCardIndex, size_t destStackIndex)
+	{
+		PANDA_PROFILE_SCOPE("SpiderGame::moveCards");
+		if (!canMoveCards(sourceStackIndex, sourceCardIndex, destStackIndex))
+			return false;
+
+		MoveBuffer buffer;
+		std::optional<CardStack> toMove = m_stacks[sourceStackIndex].take(sourceCardIndex, &buffer);
+		if (!toMove)
+			return false;
+
+		// the cards left on the source keep their run lengths
+		m_runs[sourceStackIndex - 9].resize(sourceCardIndex);
+
+		CardStack& dest = m_stacks[destStackIndex];
+		size_t first = dest.size();
+		dest.append(std::move(*toMove));
+		updateRuns(destStackIndex, first);
+
+		settle(destStackIndex);
+		settle(sourceStackIndex);
+		return true;
+	}
+
+	std::vector<Move> SpiderGame::legalMoves() const
+	{
+		std::vector<Move> moves;
+		if (canDeal())
+			moves.push_back(Move{Move::Type::Draw});
+
+		for (size_t sourceIndex : centralStacksIndices())
+		{
+			const CardStack& source = m_stacks[sourceIndex];
+			size_t run = runLength(sourceIndex);
+			for (size_t cardIndex = source.size() - run; cardIndex < source.size(); ++cardIndex)
+			{
+				for (size_t destIndex : centralStacksIndices())
+				{
+					if (canMoveCards(sourceIndex, cardIndex, destIndex))
+						moves.push_back(Move{Move::Type::Cards, sourceIndex, cardIndex, destIndex});
+				}
+			}
+		}
+		return moves;
+	}
+
+	bool SpiderGame::applyMove(const Move& move)
+	{
+		switch (move.type)
+		{
+		case Move::Type::Draw:
+			return deal();
+		case Move::Type::Flip:
+			return false;    // top cards are opened as soon as they are uncovered
+		case Move::Type::Cards:
+			return moveCards(move.sourceStack, move.sourceCard, move.destStack);
+		}
+		return false;
+	}
+
+	size_t SpiderGame::hash() const
+	{
+		// FNV-1a over every card, with a separator per stack
+		uint64_t h = 14695981039346656037ull;
+		auto add = [&h](uint64_t value) {
+			h ^= value;
+			h *= 1099511628211ull;
+		};
+
+		for (const CardStack& stack : m_stacks)
+		{
+			for (const Card& card : stack.cards())
+				add(static_cast<uint64_t>(card.number) | static_cast<uint64_t>(card.suit) << 4 | static_cast<uint64_t>(card.state) << 6);
+			add(0xFF);
+		}
+		return static_cast<size_t>(h);
+	}
+
+	size_t SpiderGame::runLength(size_t stack) const
+	{
+		if (!isCentralStack(stack))
+			return 0;
+
+		const std::vector<uint8_t>& runs = m_runs[stack - 9];
+		return runs.empty() ? 0 : runs.back();
+	}
+
+	void SpiderGame::updateRuns(size_t stack, size_t firstCardIndex)
+	{
+		const std::pmr::vector<Card>& cards = m_stacks[stack].cards();
+		std::vector<uint8_t>& runs = m_runs[stack - 9];
+		runs.resize(cards.size());
+
+		for (size_t i = firstCardIndex; i < cards.size(); ++i)
+		{
+			if (cards[i].state == Card::State::Closed)
+				runs[i] = 0;
+			else if (i > 0 && continuesRun(cards[i - 1], cards[i]))
+				runs[i] = static_cast<uint8_t>(runs[i - 1] + 1);
+			else
+				runs[i] = 1;
+		}
+	}
+
+	void SpiderGame::settle(size_t stack)
+	{
+		CardStack& cards = m_stacks[stack];
+		std::vector<uint8_t>& runs = m_runs[stack - 9];
+
+		// a run from king to ace leaves the table, to the first free end stack
+		if (!runs.empty() && runs.back() == 13)
+		{
+			std::optional<CardStack> run = cards.take(cards.size() - 13);
+			runs.resize(cards.size());
+			m_stacks[1 + m_completedRuns].append(std::move(*run));
+			++m_completedRuns;
+			if (m_completedRuns == 8)
+				m_state = State::Win;
+		}
+
+		// the uncovered card is opened straight away, and starts a new run
+		if (cards.size() != 0 && cards.cards().back().state == Card::State::Closed)
+		{
+			cards.flipTop();
+			runs.back() = 1;
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#include "Stock.h"
+
+#include "CardStack.h"
+
+#include <algorithm>
+
+namespace panda
+{
+	Stock::Stock(std::pmr::vector<Card>&& cards)
+		: m_cards(std::move(cards))
+	{
+	}
+
+	Stock::Stock(const CardStack& closedStack, const CardStack& openStack)
+	{
+		// open cards keep their order, closed cards are drawn from the top of the stack
+		m_cards.reserve(openStack.size() + closedStack.size());
+		m_cards.insert(m_cards.end(), openStack.cards().begin(), openStack.cards().end());
+		m_cards.insert(m_cards.end(), closedStack.cards().rbegin(), closedStack.cards().rend());
+		m_split = openStack.size();
+		m_seen = m_split;
+	}
+
+	void Stock::setDrawCount(size_t count) { m_drawCount = std::max(static_cast<size_t>(1), count); }
+
+	bool Stock::draw()
+	{
+		if (closedSize() == 0)
+			return false;
+
+		m_split = std::min(m_split + m_drawCount, m_cards.size());
+		m_seen = std::max(m_seen, m_split);
+		return true;
+	}
+
+	bool Stock::recycle()
+	{
+		if (closedSize() != 0 || m_split == 0)
+			return false;
+
+		m_split = 0;
+		return true;
+	}
+
+	std::optional<Card> Stock::top() const
+	{
+		if (m_split == 0)
+			return {};
+
+		Card card = m_cards[m_split - 1];
+		card.state = Card::State::Open;
+		return card;
+	}
+
+	std::optional<Card> Stock::takeTop()
+	{
+		std::optional<Card> card = top();
+		if (!card)
+			return {};
+
+		// the closed cards behind shift down by one, there are at most 24 of them
+		m_cards.erase(m_cards.begin() + (m_split - 1));
+		--m_split;
+		--m_seen;
+		return card;
+	}
+
+	void Stock::toStacks(CardStack& closedStack, CardStack& openStack) const
+	{
+		std::pmr::vector<Card> closedCards(m_cards.rbegin(), m_cards.rend() - m_split);
+		for (Card& card : closedCards)
+			card.state = Card::State::Closed;
+
+		std::pmr::vector<Card> openCards(m_cards.begin(), m_cards.begin() + m_split);
+		for (Card& card : openCards)
+			card.state = Card::State::Open;
+
+		closedStack = CardStack(std::move(closedCards));
+		openStack = CardStack(std::move(openCards));
+	}
+}
@@ -0,0 +1,87 @@
+#include "TelnetInput.h"
+
+namespace panda
+{
+	namespace
+	{
+		// telnet command bytes, RFC 854
+		const unsigned char IAC = 255;
+		const unsigned char WILL = 251;
+		const unsigned char DONT = 254;
+		const unsigned char SB = 250;
+		const unsigned char SE = 240;
+
+		const char KEY_ESC = 27;
+	}
+
+	std::optional<TelnetInput::Key> TelnetInput::next(const char* data, size_t size, size_t& position)
+	{
+		while (position < size)
+		{
+			char c = data[position];
+			unsigned char byte = static_cast<unsigned char>(c);
+			switch (m_state)
+			{
+			case State::Text:
+				++position;
+				if (byte == IAC)
+					m_state = State::Command;
+				else if (c == KEY_ESC)
+					m_state = State::Escape;
+				else
+					return Key{Key::Type::Char, c};
+				break;
+			case State::Command:
+				++position;
+				if (byte >= WILL && byte <= DONT)
+					m_state = State::Option;
+				else if (byte == SB)
+					m_state = State::Subnegotiation;
+				else
+					m_state = State::Text;    // two byte command, or an escaped 255 which is no key
+				break;
+			case State::Option:
+				++position;
+				m_state = State::Text;
+				break;
+			case State::Subnegotiation:
+				++position;
+				if (byte == IAC)
+					m_state = State::SubnegotiationCommand;
+				break;
+			case State::SubnegotiationCommand:
+				++position;
+				m_state = byte == SE ? State::Text : State::Subnegotiation;
+				break;
+			case State::Escape:
+				if (c == '[' || c == 'O')
+				{
+					++position;
+					m_state = State::Sequence;
+					break;
+				}
+				// a lone escape, the byte after it is a key of its own and is read next
+				m_state = State::Text;
+				return Key{Key::Type::Escape, KEY_ESC};
+			case State::Sequence:
+				++position;
+				// parameters and intermediates come before the final byte of the sequence
+				if (byte >= 0x40 && byte <= 0x7E)
+				{
+					m_state = State::Text;
+					return Key{Key::Type::Sequence, c};
+				}
+				break;
+			}
+		}
+		return std::nullopt;
+	}
+
+	std::optional<TelnetInput::Key> TelnetInput::finish()
+	{
+		if (m_state != State::Escape)
+			return std::nullopt;
+		m_state = State::Text;
+		return Key{Key::Type::Escape, KEY_ESC};
+	}
+}
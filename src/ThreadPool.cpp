@@ -0,0 +1,71 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace panda
+{
+	ThreadPool::ThreadPool(size_t threads)
+	{
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		m_threads.reserve(threads);
+		for (size_t i = 0; i < threads; ++i)
+			m_threads.emplace_back([this]() { run(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_taskReady.notify_all();
+		for (auto& thread : m_threads)
+			thread.join();
+	}
+
+	void ThreadPool::submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_tasks.push(std::move(task));
+			++m_pending;
+		}
+		m_taskReady.notify_one();
+	}
+
+	void ThreadPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_tasksDone.wait(lock, [this]() { return m_pending == 0; });
+	}
+
+	size_t ThreadPool::size() const { return m_threads.size(); }
+
+	void ThreadPool::run()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_taskReady.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+				if (m_tasks.empty())
+					return;    // stopping and nothing left to do
+
+				task = std::move(m_tasks.front());
+				m_tasks.pop();
+			}
+
+			task();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_pending;
+				if (m_pending == 0)
+					m_tasksDone.notify_all();
+			}
+		}
+	}
+}
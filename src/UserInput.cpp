@@ -1,5 +1,7 @@
 #include "UserInput.h"
 
+#include <thread>
+
 namespace panda
 {
 	namespace
@@ -9,14 +11,14 @@ namespace panda
 		const int KEY_LEFT = 75;
 		const int KEY_RIGHT = 77;
 		const int KEY_ESC = 27;
-	}
+		const int KEY_OVERLAY = 'p';
+		const int KEY_HINT = 'h';
 
-	Action UserInput::waitForInput()
-	{
-		while (true)
-		{
-			int c = _getch();
+		// How often pending input is checked while waiting with a timeout
+		const std::chrono::milliseconds pollInterval{10};
 
+		Action toAction(int c)
+		{
 			if (c == KEY_UP)
 				return Action::Up;
 			if (c == KEY_DOWN)
@@ -29,8 +31,40 @@ namespace panda
 				return Action::Use;
 			if (c == KEY_ESC)
 				return Action::Exit;
+			if (c == KEY_OVERLAY)
+				return Action::ToggleOverlay;
+			if (c == KEY_HINT)
+				return Action::Hint;
+			return Action::None;
+		}
+	}
+
+	Action UserInput::waitForInput()
+	{
+		while (true)
+		{
+			Action action = toAction(_getch());
+			if (action != Action::None)
+				return action;
+		}
+
+		return Action::None;
+	}
+
+	Action UserInput::waitForInput(std::chrono::milliseconds timeout)
+	{
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		while (std::chrono::steady_clock::now() < deadline)
+		{
+			while (_kbhit())
+			{
+				Action action = toAction(_getch());
+				if (action != Action::None)
+					return action;
+			}
+			std::this_thread::sleep_for(pollInterval);
 		}
 
 		return Action::None;
 	}
-}
\ No newline at end of file
+}
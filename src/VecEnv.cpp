@@ -0,0 +1,173 @@
+#include "VecEnv.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace panda
+{
+	namespace
+	{
+		int endCards(const Game& game)
+		{
+			int cards = 0;
+			for (int suit = 0; suit < 4; ++suit)
+				cards += game.endHeight(static_cast<Card::Suit>(suit));
+			return cards;
+		}
+	}
+
+	VecEnv::VecEnv(Config config)
+		: m_config(config)
+	{
+		m_envs.reserve(m_config.envs);
+		for (size_t i = 0; i < m_config.envs; ++i)
+		{
+			m_envs.emplace_back(Game::createRandomGame(m_config.firstSeed + static_cast<unsigned int>(i)));
+			m_envs.back().game.setDrawCount(m_config.drawCount);
+			m_envs.back().game.setAutoPlay(m_config.autoPlay);
+			m_envs.back().seed = m_config.firstSeed + static_cast<unsigned int>(i);
+		}
+
+		size_t threads = m_config.threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : m_config.threads;
+		threads = std::min(threads, std::max<size_t>(1, m_envs.size()));
+		if (threads > 1)
+			m_pool = std::make_unique<ThreadPool>(threads);
+	}
+
+	template <class Function>
+	void VecEnv::forEachShard(Function function)
+	{
+		if (!m_pool)
+		{
+			for (size_t i = 0; i < m_envs.size(); ++i)
+				function(i);
+			return;
+		}
+
+		// contiguous shards, each thread writes its own part of the buffers
+		// the task captures two pointers so it fits in the small buffer of std::function
+		struct Shards
+		{
+			Function& function;
+			size_t envs;
+			size_t count;
+		} shards{function, m_envs.size(), m_pool->size()};
+		for (size_t shard = 0; shard < shards.count; ++shard)
+		{
+			m_pool->submit([&shards, shard]() {
+				size_t last = shards.envs * (shard + 1) / shards.count;
+				for (size_t i = shards.envs * shard / shards.count; i < last; ++i)
+					shards.function(i);
+			});
+		}
+		m_pool->wait();
+	}
+
+	void VecEnv::reset(const Buffers& out, const unsigned int* seeds)
+	{
+		forEachShard([this, &out, seeds](size_t index) {
+			Env& env = m_envs[index];
+			deal(env, seeds ? seeds[index] : env.seed);
+			out.rewards[index] = 0.0f;
+			out.dones[index] = 0;
+			write(index, out);
+		});
+	}
+
+	void VecEnv::step(const uint32_t* actions, const Buffers& out)
+	{
+		forEachShard([this, actions, &out](size_t index) { stepEnv(index, actions[index], out); });
+	}
+
+	uint32_t VecEnv::actionOf(const Move& move)
+	{
+		switch (move.type)
+		{
+		case Move::Type::Draw:
+			return 0;
+		case Move::Type::Flip:
+			return static_cast<uint32_t>(1 + move.sourceStack * stackCount + move.sourceStack);
+		case Move::Type::Cards:
+			return static_cast<uint32_t>(1 + move.sourceStack * stackCount + move.destStack);
+		}
+		return 0;
+	}
+
+	VecEnv::Stats VecEnv::stats() const
+	{
+		Stats total;
+		for (const Env& env : m_envs)
+		{
+			total.steps += env.stats.steps;
+			total.episodes += env.stats.episodes;
+			total.wins += env.stats.wins;
+			total.illegalActions += env.stats.illegalActions;
+		}
+		return total;
+	}
+
+	void VecEnv::deal(Env& env, unsigned int seed)
+	{
+		env.game.reset(Game::createRandomGame(seed));
+		env.seed = seed;
+		env.steps = 0;
+		env.endCards = endCards(env.game);
+		env.game.legalMoves(env.moves);
+	}
+
+	void VecEnv::stepEnv(size_t index, uint32_t action, const Buffers& out)
+	{
+		Env& env = m_envs[index];
+		env.stats.steps++;
+		env.steps++;
+
+		// the move of the action is looked up in the legal moves, at most one move fits a source and dest stack
+		auto move = std::find_if(env.moves.begin(), env.moves.end(), [action](const Move& move) { return actionOf(move) == action; });
+		if (move == env.moves.end() || !env.game.applyMove(*move))
+			env.stats.illegalActions++;
+
+		int cards = endCards(env.game);
+		out.rewards[index] = static_cast<float>(cards - env.endCards);
+		env.endCards = cards;
+		env.game.legalMoves(env.moves);
+
+		bool done = env.game.state() != Game::State::Playing || env.moves.empty() || env.steps >= m_config.maxSteps;
+		out.dones[index] = done ? 1 : 0;
+		if (done)
+		{
+			env.stats.episodes++;
+			if (env.game.state() == Game::State::Win)
+				env.stats.wins++;
+			deal(env, env.seed + static_cast<unsigned int>(m_envs.size()));
+		}
+		write(index, out);
+	}
+
+	void VecEnv::write(size_t index, const Buffers& out)
+	{
+		const Env& env = m_envs[index];
+		uint8_t* observation = out.observations + index * observationSize;
+		for (size_t id = 0; id < cardCount; ++id)
+		{
+			std::optional<Game::CardLocation> location = env.game.locate(cardFromId(id));
+			uint8_t* entry = observation + id * 3;
+			if (!location)
+			{
+				entry[0] = entry[1] = entry[2] = 0xFF;
+				continue;
+			}
+			entry[0] = static_cast<uint8_t>(location->stack);
+			entry[1] = static_cast<uint8_t>(location->index);
+			// the stock stacks are read from their index, Game::stacks would rebuild them on every step
+			bool open = Game::isOpenStack(location->stack);
+			if (!Game::isClosedStack(location->stack) && !open)
+				open = env.game.stack(location->stack).cards()[location->index].state == Card::State::Open;
+			entry[2] = open ? 1 : 0;
+		}
+
+		uint8_t* mask = out.masks + index * actionCount;
+		std::memset(mask, 0, actionCount);
+		for (const Move& move : env.moves)
+			mask[actionOf(move)] = 1;
+	}
+}
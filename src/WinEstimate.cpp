@@ -0,0 +1,159 @@
+#include "WinEstimate.h"
+
+#include "Policy.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+namespace panda
+{
+	namespace
+	{
+		// Fisher-Yates shuffle driven directly by the engine output, same as the deals, so seeded samples match on every platform
+		void shuffleCards(std::pmr::vector<Card>& cards, std::mt19937& g)
+		{
+			for (size_t i = cards.size(); i > 1; --i)
+			{
+				size_t j = static_cast<size_t>(g() % i);
+				std::swap(cards[i - 1], cards[j]);
+			}
+		}
+	}
+
+	namespace WinEstimate
+	{
+		Estimate estimate(const Game& game, const Config& config)
+		{
+			ThreadPool pool(config.threads);
+			return estimate(game, config, pool);
+		}
+
+		Estimate estimate(const Game& game, const Config& config, ThreadPool& pool)
+		{
+			if (!createPolicy(config.policy))
+				throw std::invalid_argument("Unknown policy: " + config.policy);
+
+			auto start = std::chrono::steady_clock::now();
+			auto deadline = start + config.budget;
+
+			// samples are numbered, each is dealt from its own seed so the result does not depend on the threads
+			std::atomic<size_t> next{0};
+			std::atomic<size_t> samples{0};
+			std::atomic<size_t> wins{0};
+			for (size_t thread = 0; thread < pool.size(); ++thread)
+			{
+				pool.submit([&]() {
+					std::unique_ptr<Policy> policy = createPolicy(config.policy);
+					size_t threadSamples = 0;
+					size_t threadWins = 0;
+					while (std::chrono::steady_clock::now() < deadline)
+					{
+						size_t index = next++;
+						if (index >= config.maxSamples || (config.cancelled && config.cancelled->load(std::memory_order_relaxed)))
+							break;
+
+						std::mt19937 rng(config.seed + static_cast<unsigned int>(index));
+						Game played = sample(game, rng);
+						Simulation::playOut(played, *policy, rng, config.maxMoves);
+						++threadSamples;
+						if (played.state() == Game::State::Win)
+							++threadWins;
+					}
+					samples += threadSamples;
+					wins += threadWins;
+				});
+			}
+			pool.wait();
+
+			Estimate result;
+			result.samples = samples;
+			result.wins = wins;
+			result.probability = result.samples == 0 ? 0.0 : static_cast<double>(result.wins) / result.samples;
+			std::tie(result.low, result.high) = interval(result.wins, result.samples);
+			result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			return result;
+		}
+
+		Game sample(const Game& game, std::mt19937& rng)
+		{
+			// only stack reads that leave the game untouched, Game::stacks rebuilds the stock stacks and the samples run on many threads
+			const Stock& stock = game.stock();
+			const std::pmr::vector<Card>& buffer = stock.cards();
+			size_t unseen = std::max(stock.openSize(), stock.seenSize());
+
+			// the unseen cards are shuffled among the places they hide in, stock cards seen before the stock was turned over stay where they are
+			std::pmr::vector<Card> hidden(buffer.begin() + unseen, buffer.end());
+			for (size_t index : Game::centralStacksIndices())
+			{
+				for (const Card& card : game.stack(index).cards())
+				{
+					if (card.state == Card::State::Closed)
+						hidden.push_back(card);
+				}
+			}
+			shuffleCards(hidden, rng);
+
+			auto deal = [&hidden](const CardStack& stack) {
+				std::pmr::vector<Card> cards(stack.cards().begin(), stack.cards().end());
+				for (Card& card : cards)
+				{
+					if (card.state != Card::State::Closed)
+						continue;
+					card = hidden.back();
+					hidden.pop_back();
+				}
+				return CardStack(std::move(cards));
+			};
+
+			std::array<CardStack, 4> endStack;
+			for (size_t i = 0; i < endStack.size(); ++i)
+				endStack[i] = game.stack(Game::endStacksIndices()[i]);
+			std::array<CardStack, 7> centralStack;
+			for (size_t i = 0; i < centralStack.size(); ++i)
+				centralStack[i] = deal(game.stack(Game::centralStacksIndices()[i]));
+
+			// the buffer holds the open cards first, then the closed cards in draw order, the closed stack has the next card on top
+			std::pmr::vector<Card> openCards(buffer.begin(), buffer.begin() + stock.openSize());
+			for (Card& card : openCards)
+				card.state = Card::State::Open;
+			std::pmr::vector<Card> closedCards;
+			closedCards.reserve(stock.closedSize());
+			for (size_t i = buffer.size(); i-- > stock.openSize();)
+			{
+				Card card = buffer[i];
+				if (i >= unseen)
+				{
+					card = hidden.back();
+					hidden.pop_back();
+				}
+				card.state = Card::State::Closed;
+				closedCards.push_back(card);
+			}
+
+			Game sampled(Game::Stacks(std::move(endStack), std::move(centralStack), CardStack(std::move(closedCards)), CardStack(std::move(openCards))));
+			sampled.setDrawCount(game.drawCount());
+			sampled.setAutoPlay(game.autoPlay());
+			return sampled;
+		}
+
+		std::pair<double, double> interval(size_t wins, size_t samples)
+		{
+			if (samples == 0)
+				return {0.0, 1.0};
+
+			const double z = 1.96;
+			double n = static_cast<double>(samples);
+			double p = static_cast<double>(wins) / n;
+			double denominator = 1.0 + z * z / n;
+			double center = (p + z * z / (2.0 * n)) / denominator;
+			double margin = z * std::sqrt(p * (1.0 - p) / n + z * z / (4.0 * n * n)) / denominator;
+			return {std::max(0.0, center - margin), std::min(1.0, center + margin)};
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#include "WinEstimateEngine.h"
+
+namespace panda
+{
+	WinEstimateEngine::WinEstimateEngine(WinEstimate::Config config)
+		: m_config(config)
+		, m_pool(config.threads)
+	{
+		m_config.cancelled = &m_cancel;
+		m_thread = std::thread([this]() { run(); });
+	}
+
+	WinEstimateEngine::~WinEstimateEngine()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+			m_cancel = true;
+		}
+		m_requested.notify_one();
+		m_thread.join();
+	}
+
+	std::optional<WinEstimate::Estimate> WinEstimateEngine::estimate(const Game& game) const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (game.hash() != m_hash)
+			return {};
+		return m_estimate;
+	}
+
+	void WinEstimateEngine::request(const Game& game)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			size_t hash = game.hash();
+			if (hash == m_hash && (m_estimate || m_pending || m_estimating))
+				return;
+
+			// the latest request replaces anything older, there is no point finishing it
+			m_hash = hash;
+			m_estimate.reset();
+			m_pending = game;
+			m_cancel = true;
+		}
+		m_requested.notify_one();
+	}
+
+	bool WinEstimateEngine::estimating() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_pending.has_value() || m_estimating;
+	}
+
+	void WinEstimateEngine::run()
+	{
+		while (true)
+		{
+			std::optional<Game> game;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_estimating = false;
+				m_requested.wait(lock, [this]() { return m_stop || m_pending.has_value(); });
+				if (m_stop)
+					return;
+
+				game = std::move(m_pending);
+				m_pending.reset();
+				m_cancel = false;
+				m_estimating = true;
+			}
+
+			WinEstimate::Estimate estimate = WinEstimate::estimate(*game, m_config, m_pool);
+
+			// cancelled estimates are cut short, a new request is already waiting
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (!m_cancel)
+				m_estimate = estimate;
+			m_estimating = false;
+		}
+	}
+}
@@ -3,16 +3,24 @@
 #include "AppRender.h"
 #include "Card.h"
 #include "CardStack.h"
+#include "DealRating.h"
+#include "EngineProtocol.h"
+#include "FrameStats.h"
 #include "Game.h"
 #include "GameControl.h"
 #include "GameFileIO.h"
 #include "GameRender.h"
+#include "HintEngine.h"
 #include "Layout.h"
 #include "Menu.h"
 #include "MenuControl.h"
 #include "MenuRender.h"
 #include "MenuSelection.h"
+#include "PerfOverlayRender.h"
+#include "Profiler.h"
 #include "UserInput.h"
+#include "WinEstimate.h"
+#include "WinEstimateEngine.h"
 
 #ifdef WIN32
 #	include "ConsoleWindows.h"
@@ -25,48 +33,28 @@
 #include <assert.h>
 #include <chrono>
 #include <iostream>
+#include <optional>
+#include <sstream>
+#include <random>
+#include <string>
 #include <thread>
 
 using namespace panda;
 
-Layout createGameLayout()
+// Deals a new game, from the rating file written by soliterminal-rate when a difficulty is asked for and it was rated for the draw count
+Game createGame(std::optional<Difficulty> difficulty, size_t drawCount)
 {
-	// map game to the layout, where top row contains open, closed, end stacks, and bottom row contains central stacks
-	// bottom row is one index down
-	// layout is as follows:
-	// 0:closed	| 1:open	| -			| 2:end0	| 3:end1	| 4:end2	| 5:end3	|
-	// 6:cen0	| 7:cen1	| 8:cen2	| 9:cen3	| 10:cen4	| 11:cen5	| 12:cen6	|
-	Graph graph;
-	graph.addNode(0, {0, 0});
-	graph.addNode(1, {1, 0});
-	graph.addNode(2, {3, 0});
-	graph.addNode(3, {4, 0});
-	graph.addNode(4, {5, 0});
-	graph.addNode(5, {6, 0});
-	graph.addNode(6, {0, 1});
-	graph.addNode(7, {1, 1});
-	graph.addNode(8, {2, 1});
-	graph.addNode(9, {3, 1});
-	graph.addNode(10, {4, 1});
-	graph.addNode(11, {5, 1});
-	graph.addNode(12, {6, 1});
-
-	graph.addHorChain({0, 1, 2, 3, 4, 5});
-	graph.addHorChain({6, 7, 8, 9, 10, 11, 12});
-
-	graph.addVerEdge(0, 6);
-	graph.addVerEdge(1, 7);
-	graph.addVerEdge(2, 9);
-	graph.addVerEdge(3, 10);
-	graph.addVerEdge(4, 11);
-	graph.addVerEdge(5, 12);
-
-	// add an edge that only goes up
-	graph.addUpEdge(8, 1);
-	return Layout(std::move(graph));
+	std::random_device rd;
+	if (difficulty)
+	{
+		std::mt19937 rng(rd());
+		if (std::optional<unsigned int> seed = DealRating::pickSeed(DealRating::defaultPath(), *difficulty, drawCount, rng))
+			return Game::createRandomGame(*seed);
+	}
+	return Game::createRandomGame(rd());
 }
 
-Game loadOrCreateGame()
+Game loadOrCreateGame(std::optional<Difficulty> difficulty)
 {
 	// Try to load game if one exists already
 	if (GameFileIO::hasSavedGame())
@@ -76,9 +64,65 @@ Game loadOrCreateGame()
 			return *game;
 	}
 
-	return Game::createRandomGame();
+	Game game = createGame(difficulty, 3);
+	game.setDrawCount(3);
+	return game;
+}
+
+// Returns if --protocol is given, the game is then played by another program over stdin and stdout
+bool protocolMode(int argc, char** argv)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::string(argv[i]) == "--protocol")
+			return true;
+	}
+	return false;
+}
+
+// Reads --difficulty easy|medium|hard, any other argument is ignored
+std::optional<Difficulty> parseArguments(int argc, char** argv)
+{
+	std::optional<Difficulty> difficulty;
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (std::string(argv[i]) == "--difficulty")
+			difficulty = DealRating::parseDifficulty(argv[++i]);
+	}
+	return difficulty;
 }
 
+// Menu line with the chance to win from the position, estimated in the background in a fraction of a second on all cores
+std::string winChanceText(const Game& game, WinEstimateEngine& winEstimates)
+{
+	if (game.state() == Game::State::Lose)
+		return "The game is lost, no move can change it";
+	if (game.state() != Game::State::Playing)
+		return "";
+
+	std::optional<WinEstimate::Estimate> estimate = winEstimates.estimate(game);
+	if (!estimate)
+	{
+		winEstimates.request(game);    // returns straight away, a state already being estimated is not started again
+		return "Estimating the chance to win...";
+	}
+
+	std::ostringstream text;
+	text.precision(0);
+	text << std::fixed << "Chance to win " << estimate->probability * 100.0 << "% (" << estimate->low * 100.0 << "-" << estimate->high * 100.0
+		 << "%, " << estimate->samples << " samples)";
+	return text.str();
+}
+
+#ifdef SOLITERMINAL_PROFILING
+std::filesystem::path tracePath()
+{
+	auto pathDir = FilesystemUtils::appDataPath() / "Soliterminal";
+	std::filesystem::create_directory(pathDir);
+	return pathDir / "trace.json";
+}
+#endif
+
 std::unique_ptr<Console> consoleProxy()
 {
 #ifdef WIN32
@@ -97,44 +141,69 @@ std::unique_ptr<Console> consoleProxy()
 	return {};
 }
 
-int main()
+int main(int argc, char** argv)
 {
 	try
 	{
+		// no console is opened, commands are read line by line and nothing is drawn
+		if (protocolMode(argc, argv))
+		{
+			std::ios::sync_with_stdio(false);
+			EngineProtocol protocol(std::cout);
+			protocol.run(std::cin);
+			return 0;
+		}
+
+		std::optional<Difficulty> difficulty = parseArguments(argc, argv);
+
 		std::unique_ptr<Console> console = consoleProxy();
 		assert(console != nullptr);    // Console not initialized
 		if (!console)
 			return -1;
 
-		Game game = loadOrCreateGame();
+		Game game = loadOrCreateGame(difficulty);
+		game.setAutoPlay(true);
 
 		App app;
 
 		Layout gameLayout = createGameLayout();
-		GameControl gameControl(game, gameLayout);
-
-		Menu menu{"Soliterminal",
-				  "",
-				  {{"Resume", [&app]() { app.setState(App::State::Game); }},
-				   {"New Game",
-					[&app, &game, &gameControl]() {
-						game.reset(Game::createRandomGame());
-						gameControl.reset();
-						app.setState(App::State::Game);
-					}},
-				   {"Save and Exit",
-					[&app, &game]() {
-						GameFileIO::saveGame(game);
-						app.setState(App::State::Exit);
-					}},
-				   {"Exit without saving", [&app]() { app.setState(App::State::Exit); }}}};
+		HintEngine hintEngine;
+		WinEstimate::Config winEstimateConfig;
+		winEstimateConfig.budget = std::chrono::milliseconds(150);
+		WinEstimateEngine winEstimates(winEstimateConfig);
+		GameControl gameControl(game, gameLayout, hintEngine);
+
+		std::vector<Option> menuOptions{{"Resume", [&app]() { app.setState(App::State::Game); }},
+										{"New Game",
+										 [&app, &game, &gameControl, difficulty]() {
+											 game.reset(createGame(difficulty, game.drawCount()));
+											 gameControl.reset();
+											 app.setState(App::State::Game);
+										 }},
+										{"Toggle auto play", [&game]() { game.setAutoPlay(!game.autoPlay()); }},
+										{"Toggle draw one or three", [&game]() { game.setDrawCount(game.drawCount() == 3 ? 1 : 3); }},
+										{"Save and Exit",
+										 [&app, &game]() {
+											 GameFileIO::saveGame(game);
+											 app.setState(App::State::Exit);
+										 }},
+										{"Exit without saving", [&app]() { app.setState(App::State::Exit); }}};
+#ifdef SOLITERMINAL_PROFILING
+		menuOptions.insert(menuOptions.begin() + 2, {"Save profile trace", []() { Profiler::writeTrace(tracePath()); }});
+#endif
+		Menu menu{"Soliterminal", "", std::move(menuOptions)};
 
 		MenuControl menuControl(menu);
 		GameRender gameRender(game, gameControl.selection(), gameLayout, *console);
 		MenuRender menuRender(menu, menuControl.selection(), *console);
+		FrameStats frameStats;
+		PerfOverlayRender overlayRender(frameStats, gameRender.right(), *console);
 
 		AppControl appControl(app, AppControl::Controls{gameControl, menuControl});
-		AppRender appRender(app, AppRender::Renders{gameRender, menuRender});
+		AppRender appRender(app, AppRender::Renders{gameRender, menuRender, overlayRender}, *console);
+
+		// Draw the initial frame
+		appRender.update();
 
 		// Basic application cycle
 		while (true)
@@ -142,12 +211,32 @@ int main()
 			if (app.state() == App::State::Exit)
 				break;
 
-			Action action = UserInput::waitForInput();
+			// while a hint or the chance to win is searched, wake up regularly so it shows as soon as it is found
+			bool pending = gameControl.hintPending() || (app.state() == App::State::Pause && winEstimates.estimating());
+			Action action = pending ? UserInput::waitForInput(std::chrono::milliseconds(50)) : UserInput::waitForInput();
+
+			// frame time covers handling the input and drawing its result
+			auto frameStart = std::chrono::steady_clock::now();
 			appControl.action(action);
+			if (app.state() == App::State::Pause)
+				menu.setText(winChanceText(game, winEstimates));
 			appRender.update();
+			frameStats.addFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+
+			// once the game is decided, finish it at once and animate the cards going to the end stacks
+			if (app.state() == App::State::Game && game.canAutoComplete())
+			{
+				Game before = game;
+				std::vector<Move> moves = game.autoComplete();
+				gameRender.playback(before, moves);
+				appRender.update();
+			}
 		}
 
 		console->clear();
+#ifdef SOLITERMINAL_PROFILING
+		Profiler::writeTrace(tracePath());
+#endif
 	}
 	catch (std::runtime_error& e)
 	{
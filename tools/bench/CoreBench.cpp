@@ -0,0 +1,395 @@
+#include "Card.h"
+#include "CardStack.h"
+#include "EngineProtocol.h"
+#include "Game.h"
+#include "GameBatch.h"
+#include "GameFileIO.h"
+#include "GameTensor.h"
+#include "PackedGame.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <random>
+#include <sstream>
+
+using namespace panda;
+
+namespace
+{
+	// Fixed seed so every run measures the same deals
+	const unsigned int kSeed = 42;
+
+	CardStack openRun(size_t count)
+	{
+		std::pmr::vector<Card> cards;
+		for (size_t i = 0; i < count; ++i)
+			cards.emplace_back(static_cast<int>(13 - i % 13), static_cast<Card::Suit>(i % 4), Card::State::Open);
+		return CardStack(std::move(cards));
+	}
+
+	// Seeded deals played a few random moves in, so the stacks are not all fresh
+	std::vector<Game> batchGames(size_t count)
+	{
+		std::vector<Game> games;
+		std::mt19937 rng(kSeed);
+		for (size_t i = 0; i < count; ++i)
+		{
+			Game game = Game::createRandomGame(kSeed + static_cast<unsigned int>(i));
+			for (size_t move = 0; move < 30; ++move)
+			{
+				std::vector<Move> moves = game.legalMoves();
+				if (moves.empty())
+					break;
+				game.applyMove(moves[rng() % moves.size()]);
+			}
+			games.push_back(std::move(game));
+		}
+		return games;
+	}
+
+	// Two kings and a queen, the queen can move between the kings forever
+	// A card left to draw keeps the game playing, without it the moves would be timed on a lost game
+	Game pingPongGame()
+	{
+		std::array<CardStack, 7> centralStack;
+		centralStack[0] = CardStack({Card(13, Card::Suit::Spade), Card(12, Card::Suit::Heart)});
+		centralStack[1] = CardStack({Card(13, Card::Suit::Club)});
+		CardStack closedStack({Card(2, Card::Suit::Heart, Card::State::Closed)});
+		return Game(Game::Stacks(std::array<CardStack, 4>(), std::move(centralStack), std::move(closedStack), CardStack()));
+	}
+}
+
+static void BM_CardIsSameColor(benchmark::State& state)
+{
+	Card heart(5, Card::Suit::Heart);
+	Card spade(6, Card::Suit::Spade);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(heart);
+		benchmark::DoNotOptimize(heart.isSameColor(spade));
+	}
+}
+BENCHMARK(BM_CardIsSameColor);
+
+static void BM_CardCentralRule(benchmark::State& state)
+{
+	// The full comparison chain used by Game to place a card on a central stack
+	Card source(5, Card::Suit::Heart);
+	Card dest(6, Card::Suit::Spade);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(source);
+		benchmark::DoNotOptimize(!source.isSameColor(dest) && source.isLower(dest) && source.isAdjacent(dest));
+	}
+}
+BENCHMARK(BM_CardCentralRule);
+
+static void BM_CardStackTakeAppend(benchmark::State& state)
+{
+	CardStack stack = openRun(static_cast<size_t>(state.range(0)));
+	size_t index = stack.size() / 2;
+	for (auto _ : state)
+	{
+		std::optional<CardStack> taken = stack.take(index);
+		stack.append(std::move(*taken));
+		benchmark::ClobberMemory();
+	}
+}
+BENCHMARK(BM_CardStackTakeAppend)->Arg(2)->Arg(13)->Arg(24);
+
+static void BM_CardStackFirstOpenCard(benchmark::State& state)
+{
+	// closed cards below a single open one, the worst case for the scan
+	CardStack stack = openRun(static_cast<size_t>(state.range(0)));
+	stack.flipAll();
+	stack.flipTop();
+	for (auto _ : state)
+		benchmark::DoNotOptimize(stack.firstOpenCard());
+}
+BENCHMARK(BM_CardStackFirstOpenCard)->Arg(1)->Arg(7)->Arg(13);
+
+static void BM_GameMoveCards(benchmark::State& state)
+{
+	Game game = pingPongGame();
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(game.moveCards(6, 1, 7));
+		benchmark::DoNotOptimize(game.moveCards(7, 1, 6));
+	}
+	if (game.state() != Game::State::Playing)
+		state.SkipWithError("the game left the playing state");
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_GameMoveCards);
+
+static void BM_GameCheckWinPlaying(benchmark::State& state)
+{
+	Game game = Game::createRandomGame(kSeed);
+	for (auto _ : state)
+		game.checkWin();
+}
+BENCHMARK(BM_GameCheckWinPlaying);
+
+static void BM_GameCheckWinComplete(benchmark::State& state)
+{
+	// every end stack is full, checkWin has to look at all 52 cards
+	Game game = Game::createNearEndingGame();
+	for (auto _ : state)
+		game.checkWin();
+}
+BENCHMARK(BM_GameCheckWinComplete);
+
+static void BM_GameLegalMoves(benchmark::State& state)
+{
+	Game game = Game::createRandomGame(kSeed);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(game.legalMoves());
+}
+BENCHMARK(BM_GameLegalMoves);
+
+static void BM_GameLocate(benchmark::State& state)
+{
+	Game game = Game::createRandomGame(kSeed);
+	size_t id = 0;
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(game.locate(cardFromId(id)));
+		id = (id + 1) % cardCount;
+	}
+}
+BENCHMARK(BM_GameLocate);
+
+static void BM_GameDrawCycle(benchmark::State& state)
+{
+	// one full pass through the closed stack, including turning it over
+	Game game = Game::createRandomGame(kSeed);
+	game.setDrawCount(static_cast<size_t>(state.range(0)));
+	size_t draws = (game.stock().size() + game.drawCount() - 1) / game.drawCount() + 1;
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < draws; ++i)
+			game.openCard();
+	}
+	state.SetItemsProcessed(state.iterations() * draws);
+}
+BENCHMARK(BM_GameDrawCycle)->Arg(1)->Arg(3);
+
+static void BM_CreateRandomGame(benchmark::State& state)
+{
+	unsigned int seed = kSeed;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(Game::createRandomGame(seed++));
+}
+BENCHMARK(BM_CreateRandomGame);
+
+static void BM_GameFileIOSaveLoad(benchmark::State& state)
+{
+	auto path = std::filesystem::temp_directory_path() / "soliterminal-bench-save.json";
+	Game game = Game::createRandomGame(kSeed);
+	for (auto _ : state)
+	{
+		GameFileIO::saveGame(game, path);
+		benchmark::DoNotOptimize(GameFileIO::loadGame(path));
+	}
+	std::filesystem::remove(path);
+}
+BENCHMARK(BM_GameFileIOSaveLoad);
+
+static void BM_GameAutoComplete(benchmark::State& state)
+{
+	// every card open on the central stacks, one king to ace run per suit
+	std::array<CardStack, 7> centralStack;
+	for (size_t suitIndex = 0; suitIndex < 4; ++suitIndex)
+	{
+		std::pmr::vector<Card> cards;
+		for (int number = 13; number >= 1; --number)
+			cards.emplace_back(number, static_cast<Card::Suit>(suitIndex), Card::State::Open);
+		centralStack[suitIndex] = CardStack(std::move(cards));
+	}
+	Game decided(Game::Stacks(std::array<CardStack, 4>(), std::move(centralStack), CardStack(), CardStack()));
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		Game game = decided;
+		state.ResumeTiming();
+		benchmark::DoNotOptimize(game.autoComplete());
+	}
+}
+BENCHMARK(BM_GameAutoComplete);
+
+static void BM_EngineProtocolCommands(benchmark::State& state)
+{
+	// what a bot sends for every move: the legal moves, one of them and the resulting state
+	std::ostringstream out;
+	EngineProtocol protocol(out);
+	unsigned int seed = kSeed;
+	for (auto _ : state)
+	{
+		protocol.execute("moves");
+		protocol.execute("play d");
+		protocol.execute("state");
+		if (protocol.game().stock().closedSize() == 0)
+		{
+			protocol.execute("position seed " + std::to_string(seed++));
+			out.str({});
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_EngineProtocolCommands);
+
+template <class Rules>
+static void BM_RulesLegalMoves(benchmark::State& state)
+{
+	BasicGame<Rules> game = BasicGame<Rules>::createRandomGame(kSeed);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(game.legalMoves());
+}
+BENCHMARK_TEMPLATE(BM_RulesLegalMoves, KlondikeRules);
+BENCHMARK_TEMPLATE(BM_RulesLegalMoves, KlondikeDrawThreeRules);
+BENCHMARK_TEMPLATE(BM_RulesLegalMoves, VegasRules);
+BENCHMARK_TEMPLATE(BM_RulesLegalMoves, ThumbAndPouchRules);
+
+static void BM_GamePlayout(benchmark::State& state)
+{
+	// one seeded random playout picked before timing, every iteration plays exactly these moves
+	// uses only the Game interface from before Rules.h, so results can be compared with builds older than the rules policies
+	std::vector<Move> playout;
+	{
+		Game game = Game::createRandomGame(kSeed);
+		std::mt19937 rng(kSeed);
+		for (size_t i = 0; i < 200 && game.state() == Game::State::Playing; ++i)
+		{
+			std::vector<Move> legal = game.legalMoves();
+			if (legal.empty())
+				break;
+			playout.push_back(legal[rng() % legal.size()]);
+			game.applyMove(playout.back());
+		}
+	}
+
+	for (auto _ : state)
+	{
+		Game game = Game::createRandomGame(kSeed);
+		for (const Move& move : playout)
+		{
+			benchmark::DoNotOptimize(game.legalMoves());
+			if (!game.applyMove(move))
+			{
+				state.SkipWithError("the fixed playout is not legal");
+				return;
+			}
+		}
+		benchmark::DoNotOptimize(game.hash());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(playout.size()));
+}
+BENCHMARK(BM_GamePlayout);
+
+template <class Rules>
+static void BM_RulesPlayout(benchmark::State& state)
+{
+	// the same seeded random playout for every variant, the specialised engines should keep up with Klondike
+	int64_t moves = 0;
+	for (auto _ : state)
+	{
+		BasicGame<Rules> game = BasicGame<Rules>::createRandomGame(kSeed);
+		std::mt19937 rng(kSeed);
+		for (size_t i = 0; i < 200 && game.state() == BasicGame<Rules>::State::Playing; ++i)
+		{
+			std::vector<Move> legal = game.legalMoves();
+			if (legal.empty())
+				break;
+			game.applyMove(legal[rng() % legal.size()]);
+			++moves;
+		}
+		benchmark::DoNotOptimize(game.hash());
+	}
+	state.SetItemsProcessed(moves);
+}
+BENCHMARK_TEMPLATE(BM_RulesPlayout, KlondikeRules);
+BENCHMARK_TEMPLATE(BM_RulesPlayout, KlondikeDrawThreeRules);
+BENCHMARK_TEMPLATE(BM_RulesPlayout, VegasRules);
+BENCHMARK_TEMPLATE(BM_RulesPlayout, ThumbAndPouchRules);
+
+static void BM_GameCanMoveCardsBatch(benchmark::State& state)
+{
+	// the per game baseline for GameBatch: every top card and open run against every destination
+	std::vector<Game> games = batchGames(1024);
+	for (auto _ : state)
+	{
+		for (const Game& game : games)
+		{
+			for (size_t source = 1; source < GameBatch::stackCount; ++source)
+			{
+				const CardStack& stack = game.stack(source);
+				if (stack.size() == 0)
+					continue;
+				size_t first = Game::isCentralStack(source) ? stack.firstOpenCard().value_or(stack.topIndex()) : stack.topIndex();
+				for (size_t dest = 2; dest < GameBatch::stackCount; ++dest)
+				{
+					benchmark::DoNotOptimize(game.canMoveCards(source, stack.topIndex(), dest));
+					benchmark::DoNotOptimize(game.canMoveCards(source, first, dest));
+				}
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * games.size());
+}
+BENCHMARK(BM_GameCanMoveCardsBatch);
+
+static void BM_GameTensorEncodeBatch(benchmark::State& state)
+{
+	std::vector<Game> games = batchGames(1024);
+	std::vector<float> tensor(games.size() * GameTensor::size);
+	for (auto _ : state)
+	{
+		GameTensor::encodeBatch(games.data(), games.size(), tensor.data());
+		benchmark::DoNotOptimize(tensor.data());
+	}
+	state.SetItemsProcessed(state.iterations() * games.size());
+	state.SetBytesProcessed(state.iterations() * tensor.size() * sizeof(float));
+}
+BENCHMARK(BM_GameTensorEncodeBatch);
+
+static void BM_PackedGameEncode(benchmark::State& state)
+{
+	std::vector<Game> games = batchGames(1024);
+	std::vector<PackedGame> packed(games.size());
+	bool suitSymmetry = state.range(0) != 0;
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < games.size(); ++i)
+			packed[i] = PackedGame::encode(games[i], suitSymmetry);
+		benchmark::DoNotOptimize(packed.data());
+	}
+	state.SetItemsProcessed(state.iterations() * games.size());
+	state.SetBytesProcessed(state.iterations() * packed.size() * sizeof(PackedGame));
+}
+BENCHMARK(BM_PackedGameEncode)->Arg(0)->Arg(1);
+
+static void BM_GameBatchMasks(benchmark::State& state)
+{
+	auto kernel = static_cast<GameBatch::Kernel>(state.range(0));
+	if (!GameBatch::isAvailable(kernel))
+	{
+		state.SkipWithError("kernel not compiled in");
+		return;
+	}
+
+	std::vector<Game> games = batchGames(1024);
+	GameBatch batch(games.size());
+	for (size_t i = 0; i < games.size(); ++i)
+		batch.set(i, games[i]);
+
+	state.SetLabel(GameBatch::kernelName(kernel));
+	for (auto _ : state)
+	{
+		batch.computeMasks(kernel);
+		benchmark::DoNotOptimize(batch.topMask(0, 6, 7));
+	}
+	state.SetItemsProcessed(state.iterations() * games.size());
+}
+BENCHMARK(BM_GameBatchMasks)->Arg(0)->Arg(1)->Arg(2);
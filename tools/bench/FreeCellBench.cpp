@@ -0,0 +1,43 @@
+#include "FreeCellGame.h"
+#include "FreeCellSolver.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace panda;
+
+static void BM_FreeCellDeal(benchmark::State& state)
+{
+	unsigned int dealNumber = 1;
+	for (auto _ : state)
+		benchmark::DoNotOptimize(FreeCellGame::createDeal(dealNumber++));
+}
+BENCHMARK(BM_FreeCellDeal);
+
+static void BM_FreeCellLegalMoves(benchmark::State& state)
+{
+	FreeCellGame game = FreeCellGame::createDeal(1);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(game.legalMoves());
+}
+BENCHMARK(BM_FreeCellLegalMoves);
+
+static void BM_FreeCellSolve(benchmark::State& state)
+{
+	// consecutive numbered deals, reports searched states per deal and the share of deals solved
+	unsigned int dealNumber = 1;
+	int64_t nodes = 0;
+	int64_t solved = 0;
+	int64_t deals = 0;
+	FreeCellSolver solver;
+	for (auto _ : state)
+	{
+		FreeCellSolver::Solution solution = solver.solve(FreeCellGame::createDeal(dealNumber++));
+		nodes += static_cast<int64_t>(solution.nodes);
+		solved += solution.result == FreeCellSolver::Result::Solved ? 1 : 0;
+		++deals;
+	}
+	state.SetItemsProcessed(nodes);
+	state.counters["nodesPerDeal"] = static_cast<double>(nodes) / deals;
+	state.counters["solveRate"] = static_cast<double>(solved) / deals;
+}
+BENCHMARK(BM_FreeCellSolve)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,130 @@
+#include "SpiderGame.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace panda;
+
+namespace
+{
+	// Fixed seed so every run measures the same deals
+	const unsigned int kSeed = 42;
+
+	// Scores a move for the greedy playout, negative moves are never played
+	int score(const SpiderGame& game, const Move& move)
+	{
+		if (move.type == Move::Type::Draw)
+			return 0;
+
+		const CardStack& source = game.stacks()[move.sourceStack];
+		const CardStack& dest = game.stacks()[move.destStack];
+		const Card& moved = source.cards()[move.sourceCard];
+
+		// splitting a same suit run only pays off when it joins another run of the suit
+		bool splitsRun = move.sourceCard + game.runLength(move.sourceStack) > source.size();
+		bool sameSuit = dest.size() != 0 && dest.cards().back().suit == moved.suit;
+		if (splitsRun && !sameSuit)
+			return -1;
+
+		int value = 1;
+		if (sameSuit)
+			value += 100 + static_cast<int>(source.size() - move.sourceCard);
+		if (move.sourceCard > 0 && source.cards()[move.sourceCard - 1].state == Card::State::Closed)
+			value += 50;
+		if (move.sourceCard == 0)
+			value += dest.size() == 0 ? -100 : 20;    // moving a whole stack to an empty one changes nothing
+		return value;
+	}
+
+	// Plays the highest scored move that leads to an unseen state, deals when nothing else is left
+	// Returns the number of moves played
+	size_t playGreedy(SpiderGame& game, size_t maxMoves)
+	{
+		std::unordered_set<size_t> visited{game.hash()};
+		size_t moves = 0;
+		while (game.state() == SpiderGame::State::Playing && moves < maxMoves)
+		{
+			std::vector<Move> legal = game.legalMoves();
+			std::stable_sort(legal.begin(), legal.end(), [&game](const Move& a, const Move& b) { return score(game, a) > score(game, b); });
+
+			bool played = false;
+			for (const Move& move : legal)
+			{
+				if (score(game, move) < 0)
+					break;
+
+				SpiderGame next = game;
+				next.applyMove(move);
+				if (!visited.insert(next.hash()).second)
+					continue;
+
+				game = std::move(next);
+				played = true;
+				break;
+			}
+			if (!played)
+				break;
+			++moves;
+		}
+		return moves;
+	}
+
+	// Two runs from king down, the lower one can move between them forever
+	SpiderGame pingPongGame(size_t runLength)
+	{
+		std::vector<CardStack> stacks(SpiderGame::stackCount);
+		std::pmr::vector<Card> high{Card(13, Card::Suit::Club)};
+		std::pmr::vector<Card> run{Card(13, Card::Suit::Heart)};
+		for (size_t i = 0; i < runLength; ++i)
+			run.emplace_back(static_cast<int>(12 - i), Card::Suit::Spade);
+		stacks[9] = CardStack(std::move(run));
+		stacks[10] = CardStack(std::move(high));
+		stacks[0] = CardStack(std::pmr::vector<Card>(10, Card(1, Card::Suit::Spade, Card::State::Closed)));
+		return SpiderGame(std::move(stacks));
+	}
+}
+
+static void BM_SpiderMoveRun(benchmark::State& state)
+{
+	// the run check is constant time, what grows with the run is copying the moved cards
+	size_t runLength = static_cast<size_t>(state.range(0));
+	SpiderGame game = pingPongGame(runLength);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(game.moveCards(9, 1, 10));
+		benchmark::DoNotOptimize(game.moveCards(10, 1, 9));
+	}
+	state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_SpiderMoveRun)->Arg(1)->Arg(6)->Arg(11);
+
+static void BM_SpiderLegalMoves(benchmark::State& state)
+{
+	SpiderGame game = SpiderGame::createRandomGame(kSeed);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(game.legalMoves());
+}
+BENCHMARK(BM_SpiderLegalMoves);
+
+static void BM_SpiderGreedyGame(benchmark::State& state)
+{
+	// whole seeded games with 1, 2 or 4 suits, reports moves per game and the share of games won
+	size_t suits = static_cast<size_t>(state.range(0));
+	unsigned int seed = kSeed;
+	int64_t moves = 0;
+	int64_t wins = 0;
+	int64_t games = 0;
+	for (auto _ : state)
+	{
+		SpiderGame game = SpiderGame::createRandomGame(seed++, suits);
+		moves += static_cast<int64_t>(playGreedy(game, 2000));
+		wins += game.state() == SpiderGame::State::Win ? 1 : 0;
+		++games;
+	}
+	state.SetItemsProcessed(moves);
+	state.counters["movesPerGame"] = static_cast<double>(moves) / games;
+	state.counters["winRate"] = static_cast<double>(wins) / games;
+}
+BENCHMARK(BM_SpiderGreedyGame)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond);
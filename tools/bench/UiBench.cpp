@@ -0,0 +1,41 @@
+#include "ConsoleNull.h"
+#include "Game.h"
+#include "GameRender.h"
+#include "GameSelection.h"
+#include "Layout.h"
+
+#include <benchmark/benchmark.h>
+
+using namespace panda;
+
+static void BM_LayoutNavigation(benchmark::State& state)
+{
+	Layout layout = createGameLayout();
+	size_t index = 0;
+	for (auto _ : state)
+	{
+		// walk a full loop over the top row and back through the central stacks
+		for (int i = 0; i < 6; ++i)
+			index = layout.right(index);
+		index = layout.down(index);
+		for (int i = 0; i < 6; ++i)
+			index = layout.left(index);
+		index = layout.up(index);
+		benchmark::DoNotOptimize(index);
+	}
+	state.SetItemsProcessed(state.iterations() * 14);
+}
+BENCHMARK(BM_LayoutNavigation);
+
+static void BM_GameRenderUpdate(benchmark::State& state)
+{
+	Game game = Game::createRandomGame(42);
+	Layout layout = createGameLayout();
+	GameSelection selection;
+	selection.stackIndex = 6;
+	ConsoleNull console;
+	GameRender render(game, selection, layout, console);
+	for (auto _ : state)
+		render.update();
+}
+BENCHMARK(BM_GameRenderUpdate);
@@ -0,0 +1,355 @@
+#include "GameBatch.h"
+#include "CardSet.h"
+#include "GameTensor.h"
+#include "PackedGame.h"
+#include "Policy.h"
+#include "Simulation.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <sstream>
+#include <tuple>
+#include <unordered_set>
+#include <vector>
+
+using namespace panda;
+
+namespace
+{
+	// Seeded deals played a random number of random moves in, the same positions on every run
+	std::vector<Game> randomPositions(size_t count, unsigned int firstSeed, std::mt19937& rng)
+	{
+		std::vector<Game> games;
+		games.reserve(count);
+		std::vector<Move> moves;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Game game = Game::createRandomGame(firstSeed + static_cast<unsigned int>(i));
+			size_t steps = rng() % 200;
+			for (size_t step = 0; step < steps; ++step)
+			{
+				game.legalMoves(moves);
+				if (moves.empty())
+					break;
+				game.applyMove(moves[rng() % moves.size()]);
+			}
+			games.push_back(std::move(game));
+		}
+		return games;
+	}
+
+	// Every kernel of GameBatch against the Cards moves of Game::legalMoves, for top cards and whole open runs
+	size_t checkBatchMasks(size_t& checked)
+	{
+		constexpr size_t gamesPerRound = 1000;
+		constexpr size_t rounds = 40;
+
+		size_t mismatches = 0;
+		std::mt19937 rng(7);
+		for (size_t round = 0; round < rounds; ++round)
+		{
+			std::vector<Game> games = randomPositions(gamesPerRound, static_cast<unsigned int>(round * gamesPerRound), rng);
+			GameBatch batch(games.size());
+			for (size_t i = 0; i < games.size(); ++i)
+				batch.set(i, games[i]);
+
+			for (GameBatch::Kernel kernel : {GameBatch::Kernel::Scalar, GameBatch::Kernel::Sse2, GameBatch::Kernel::Avx2})
+			{
+				if (!GameBatch::isAvailable(kernel))
+					continue;
+				batch.computeMasks(kernel);
+
+				for (size_t i = 0; i < games.size(); ++i)
+				{
+					std::set<std::tuple<size_t, size_t, size_t>> moves;
+					for (const Move& move : games[i].legalMoves())
+					{
+						if (move.type == Move::Type::Cards)
+							moves.insert({move.sourceStack, move.sourceCard, move.destStack});
+					}
+
+					for (size_t source = 1; source < GameBatch::stackCount; ++source)
+					{
+						const CardStack& stack = games[i].stack(source);
+						for (size_t dest = 2; dest < GameBatch::stackCount; ++dest)
+						{
+							bool top = stack.size() != 0 && moves.count({source, stack.topIndex(), dest}) != 0;
+							mismatches += top != batch.canMoveTop(i, source, dest) ? 1 : 0;
+							++checked;
+
+							if (!Game::isCentralStack(source))
+								continue;
+							std::optional<size_t> firstOpen = stack.firstOpenCard();
+							bool topOpen = stack.size() != 0 && stack.cards().back().state == Card::State::Open;
+							bool run = topOpen && firstOpen && moves.count({source, *firstOpen, dest}) != 0;
+							mismatches += run != batch.canMoveRun(i, source, dest) ? 1 : 0;
+						}
+					}
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	// Calls the function with every position of seeded games played with random moves, draw one and draw three in turn
+	template <class Function>
+	void forEachPlayedPosition(size_t games, size_t maxMoves, Function function)
+	{
+		std::vector<Move> moves;
+		for (unsigned int seed = 1; seed <= games; ++seed)
+		{
+			Game game = Game::createRandomGame(seed);
+			game.setDrawCount(seed % 2 ? 1 : 3);
+			std::mt19937 rng(seed);
+			for (size_t step = 0; step <= maxMoves && game.state() == Game::State::Playing; ++step)
+			{
+				function(game);
+				game.legalMoves(moves);
+				if (moves.empty())
+					break;
+				game.applyMove(moves[rng() % moves.size()]);
+			}
+		}
+	}
+
+	// Returns if both games hold the same cards in the same stacks and states, with the same stock split and hash
+	bool samePosition(const Game& a, const Game& b)
+	{
+		const auto& stacksA = a.stacks();
+		const auto& stacksB = b.stacks();
+		for (size_t stack = 0; stack < stacksA.size(); ++stack)
+		{
+			const auto& cardsA = stacksA[stack].cards();
+			const auto& cardsB = stacksB[stack].cards();
+			if (!std::equal(cardsA.begin(), cardsA.end(), cardsB.begin(), cardsB.end(), [](const Card& x, const Card& y) {
+					return x.number == y.number && x.suit == y.suit && x.state == y.state;
+				}))
+				return false;
+		}
+		return a.hash() == b.hash() && a.stock().openSize() == b.stock().openSize();
+	}
+
+	// GameTensor::decode rebuilds every encoded position, and turns away tensors with broken planes
+	size_t checkTensorRoundTrip(size_t& checked)
+	{
+		size_t mismatches = 0;
+		std::vector<float> tensor(GameTensor::size);
+		forEachPlayedPosition(1000, 150, [&](const Game& game) {
+			GameTensor::encode(game, tensor.data());
+			std::optional<Game> decoded = GameTensor::decode(tensor.data());
+			mismatches += !decoded || !samePosition(game, *decoded) ? 1 : 0;
+			++checked;
+		});
+
+		// an index that is not a whole card position is no position
+		for (float index : {std::nanf(""), 0.5f, -1.0f, 52.0f})
+		{
+			GameTensor::encode(Game::createRandomGame(1), tensor.data());
+			tensor[GameTensor::indexOffset] = index;
+			mismatches += GameTensor::decode(tensor.data()) ? 1 : 0;
+			++checked;
+		}
+		return mismatches;
+	}
+
+	// Rebuilds the game with its central and end stacks shuffled, and the suits swapped by the map when given
+	Game shuffledStacks(const Game& game, std::mt19937& rng, const std::array<Card::Suit, 4>* suits)
+	{
+		const auto& stacks = game.stacks();
+		auto copy = [suits](const CardStack& stack) {
+			std::pmr::vector<Card> cards(stack.cards().begin(), stack.cards().end());
+			for (Card& card : cards)
+				card.suit = suits ? (*suits)[static_cast<size_t>(card.suit)] : card.suit;
+			return CardStack(std::move(cards));
+		};
+
+		std::array<size_t, 4> endOrder = Game::endStacksIndices();
+		std::array<size_t, 7> centralOrder = Game::centralStacksIndices();
+		std::shuffle(endOrder.begin(), endOrder.end(), rng);
+		std::shuffle(centralOrder.begin(), centralOrder.end(), rng);
+		std::array<CardStack, 4> endStack;
+		std::array<CardStack, 7> centralStack;
+		for (size_t i = 0; i < endStack.size(); ++i)
+			endStack[i] = copy(stacks[endOrder[i]]);
+		for (size_t i = 0; i < centralStack.size(); ++i)
+			centralStack[i] = copy(stacks[centralOrder[i]]);
+
+		Game shuffled(Game::Stacks(std::move(endStack), std::move(centralStack), copy(stacks[0]), copy(stacks[1])));
+		shuffled.setDrawCount(game.drawCount());
+		return shuffled;
+	}
+
+	// PackedGame packs the decoded game as the original, and the same for shuffled stacks and swapped suits
+	size_t checkPackedRoundTrip(size_t& checked)
+	{
+		// hearts with spades and diamonds with clubs, the colors trade places
+		const std::array<Card::Suit, 4> suits{Card::Suit::Spade, Card::Suit::Club, Card::Suit::Diamond, Card::Suit::Heart};
+
+		size_t mismatches = 0;
+		std::mt19937 rng(11);
+		forEachPlayedPosition(1000, 150, [&](const Game& game) {
+			PackedGame packed = PackedGame::encode(game);
+			std::optional<Game> decoded = packed.decode();
+			bool same = decoded && PackedGame::encode(*decoded) == packed && decoded->legalMoves().size() == game.legalMoves().size();
+			same = same && PackedGame::encode(shuffledStacks(game, rng, nullptr)) == packed;
+
+			PackedGame symmetric = PackedGame::encode(game, true);
+			std::optional<Game> decodedSymmetric = symmetric.decode();
+			same = same && decodedSymmetric && PackedGame::encode(*decodedSymmetric, true) == symmetric;
+			same = same && PackedGame::encode(shuffledStacks(game, rng, &suits), true) == symmetric;
+			mismatches += same ? 0 : 1;
+			++checked;
+		});
+
+		PackedGame broken;
+		broken.words[0] = ~uint64_t(0);
+		mismatches += broken.decode() ? 1 : 0;
+		return mismatches;
+	}
+
+	// Stack of the cards written as in "[JD] 5S 4D", bottom first, closed cards in brackets
+	CardStack stackOf(const std::string& text)
+	{
+		const std::string numbers = "A23456789TJQK";
+		const std::string suits = "HDCS";
+		std::pmr::vector<Card> cards;
+		std::istringstream in(text);
+		std::string word;
+		while (in >> word)
+		{
+			bool closed = word.front() == '[';
+			size_t at = closed ? 1 : 0;
+			int number = static_cast<int>(numbers.find(word[at])) + 1;
+			Card::Suit suit = static_cast<Card::Suit>(suits.find(word[at + 1]));
+			cards.emplace_back(number, suit, closed ? Card::State::Closed : Card::State::Open);
+		}
+		return CardStack(std::move(cards));
+	}
+
+	// Returns if any sequence of moves from the position uncovers a closed central card or plays a stock card, up to a number of positions
+	// Lose positions must have none, positions the search gives up on count as lost
+	bool canProgress(const Game& start, size_t maxPositions)
+	{
+		size_t closed = bitCount(start.closedCentralCards());
+		size_t stock = start.stock().size();
+		std::deque<Game> queue{start};
+		std::unordered_set<size_t> seen{start.hash()};
+		std::vector<Move> moves;
+		while (!queue.empty() && seen.size() < maxPositions)
+		{
+			Game game = std::move(queue.front());
+			queue.pop_front();
+			game.legalMoves(moves);
+			for (const Move& move : std::vector<Move>(moves))
+			{
+				Game next = game;
+				if (!next.applyMove(move))
+					continue;
+				if (bitCount(next.closedCentralCards()) < closed || next.stock().size() < stock)
+					return true;
+				if (seen.insert(next.hash()).second)
+					queue.push_back(std::move(next));
+			}
+		}
+		return false;
+	}
+
+	// Lose is only declared where no move sequence gets anywhere, for draw one playouts without auto play and a known take-back chain
+	size_t checkLoseStates(size_t& checked)
+	{
+		size_t mismatches = 0;
+
+		// seed 1162 was declared lost after a recycle, while 8C to 9D, 7H to 8C, 6H to 7S and 5S 4D to 6H uncover the JD
+		std::array<CardStack, 4> endStack{stackOf("AH 2H 3H 4H 5H 6H 7H"), stackOf("AD 2D"), stackOf("AC 2C 3C 4C 5C 6C 7C 8C"), stackOf("AS 2S 3S")};
+		std::array<CardStack, 7> centralStack{stackOf("[JD] 5S 4D"),
+											  stackOf("[3D] [4S] [6D] 9D"),
+											  stackOf("[9H] [TH] [8H] 7S"),
+											  stackOf("[JH] [9C] [TC] [JC] KH"),
+											  stackOf("[QC] [KC] [5D] [7D] QH"),
+											  stackOf("[6S] [8D] [TD] [8S] KD"),
+											  stackOf("[9S] [TS] [JS] [QS] [KS] QD")};
+		Game chain(Game::Stacks(std::move(endStack), std::move(centralStack), CardStack(), CardStack()));
+		chain.setAutoPlay(false);
+		chain.checkLose();
+		bool playing = chain.state() == Game::State::Playing;
+		for (Move move : {Move{Move::Type::Cards, 4, 7, 7}, Move{Move::Type::Cards, 2, 6, 7}, Move{Move::Type::Cards, 2, 5, 8}, Move{Move::Type::Cards, 6, 1, 8}})
+			playing = playing && chain.applyMove(move);
+		playing = playing && chain.applyMove(Move{Move::Type::Flip, 6, 0, 6}) && chain.state() == Game::State::Playing;
+		mismatches += playing ? 0 : 1;
+		++checked;
+
+		for (const char* name : {"greedy", "random"})
+		{
+			std::unique_ptr<Policy> policy = createPolicy(name);
+			for (unsigned int seed = 1; seed <= 2000; ++seed)
+			{
+				Game game = Game::createRandomGame(seed);
+				game.setDrawCount(1);
+				game.setAutoPlay(false);
+				std::mt19937 rng(seed);
+				Simulation::playOut(game, *policy, rng, 1000);
+				if (game.state() != Game::State::Lose)
+					continue;
+				mismatches += canProgress(game, 20000) ? 1 : 0;
+				++checked;
+			}
+		}
+		return mismatches;
+	}
+
+	struct Check
+	{
+		const char* name;
+		const char* description;
+		size_t (*run)(size_t& checked);    // returns the mismatches found
+	};
+
+	const Check checks[] = {
+		{"batch", "GameBatch masks of every available kernel against Game::legalMoves", checkBatchMasks},
+		{"tensor", "GameTensor encode and decode round trip", checkTensorRoundTrip},
+		{"packed", "PackedGame round trip, and the same packing for shuffled stacks and swapped suits", checkPackedRoundTrip},
+		{"lose", "Lose states have no move sequence left that uncovers a card or plays the stock", checkLoseStates},
+	};
+
+	void printUsage()
+	{
+		std::cout << "Usage: soliterminal-check [name..]\n"
+				  << "Runs the consistency checks of the given names, or all of them, and fails on the first mismatch found\n";
+		for (const Check& check : checks)
+			std::cout << "  " << check.name << std::string(10 - std::strlen(check.name), ' ') << check.description << "\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> names(argv + 1, argv + argc);
+	for (const std::string& name : names)
+	{
+		bool known = std::any_of(std::begin(checks), std::end(checks), [&name](const Check& check) { return name == check.name; });
+		if (!known)
+		{
+			printUsage();
+			return 1;
+		}
+	}
+
+	bool failed = false;
+	for (const Check& check : checks)
+	{
+		if (!names.empty() && std::find(names.begin(), names.end(), check.name) == names.end())
+			continue;
+
+		size_t checked = 0;
+		size_t mismatches = check.run(checked);
+		std::cout << check.name << " checked=" << checked << " mismatches=" << mismatches << std::endl;
+		failed |= mismatches != 0;
+	}
+	return failed ? 1 : 0;
+}
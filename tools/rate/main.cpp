@@ -0,0 +1,279 @@
+#include "BoundedQueue.h"
+#include "DealRating.h"
+#include "Solver.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace panda;
+
+namespace
+{
+	struct Options
+	{
+		unsigned int firstSeed = 1;
+		size_t deals = 100000;
+		size_t threads = 0;    // zero uses all cores
+		size_t drawCount = 3;
+		bool solve = true;
+		size_t maxNodes = 20000;
+		size_t batchSize = 64;
+		size_t queueBatches = 64;    // capacity of each queue between stages
+		std::filesystem::path outPath = DealRating::defaultPath();
+	};
+
+	void printUsage()
+	{
+		std::cout << "Usage: soliterminal-rate [options]\n"
+				  << "  --deals N          number of consecutive seeds to rate (default 100000)\n"
+				  << "  --seed S           seed of the first deal (default 1)\n"
+				  << "  --threads T        threads shared by the stages, 0 uses all cores (default 0)\n"
+				  << "  --draw N           cards opened on each draw, 1 or 3 (default 3, as the game)\n"
+				  << "  --max-nodes M      solver nodes per deal before it counts as hard (default 20000)\n"
+				  << "  --no-solve         rate by the deal features only\n"
+				  << "  --batch N          deals passed between stages at once (default 64)\n"
+				  << "  --out FILE         rating file to write (default the one the game reads)\n";
+	}
+
+	bool parseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--no-solve")
+			{
+				options.solve = false;
+				continue;
+			}
+			if (arg == "--help" || i + 1 >= argc)
+				return false;
+
+			std::string value = argv[++i];
+			if (arg == "--deals")
+				options.deals = std::stoul(value);
+			else if (arg == "--seed")
+				options.firstSeed = static_cast<unsigned int>(std::stoul(value));
+			else if (arg == "--threads")
+				options.threads = std::stoul(value);
+			else if (arg == "--draw")
+				options.drawCount = std::stoul(value);
+			else if (arg == "--max-nodes")
+				options.maxNodes = std::stoul(value);
+			else if (arg == "--batch")
+				options.batchSize = std::max<size_t>(1, std::stoul(value));
+			else if (arg == "--out")
+				options.outPath = value;
+			else
+				return false;
+		}
+		return true;
+	}
+
+	// Deals travel through the stages in batches, each stage fills in its columns
+	struct Batch
+	{
+		size_t offset = 0;    // index of the first deal in the table
+		std::vector<Game> games;
+		std::vector<DealRating::Features> features;
+		std::vector<uint8_t> results;
+		std::vector<uint32_t> nodes;
+	};
+
+	struct StageStats
+	{
+		const char* name = "";
+		size_t threads = 0;
+		std::atomic<size_t> deals{0};
+		std::atomic<int64_t> busyNanoseconds{0};    // time spent working, summed over the threads
+	};
+
+	// Runs the work on batches from the source with the threads of the stage, closes the output once every thread is done
+	std::vector<std::thread> startStage(StageStats& stats, std::function<std::optional<Batch>()> source, std::function<void(Batch&)> work,
+										BoundedQueue<Batch>& output)
+	{
+		auto running = std::make_shared<std::atomic<size_t>>(stats.threads);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < stats.threads; ++i)
+		{
+			threads.emplace_back([&stats, source, work, &output, running]() {
+				while (std::optional<Batch> batch = source())
+				{
+					auto start = std::chrono::steady_clock::now();
+					work(*batch);
+					stats.busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+					stats.deals += batch->games.size();
+					if (!output.push(std::move(*batch)))
+						break;
+				}
+				if (--*running == 0)
+					output.close();
+			});
+		}
+		return threads;
+	}
+
+	void printStage(const StageStats& stats, double wallSeconds)
+	{
+		double busySeconds = static_cast<double>(stats.busyNanoseconds) / 1e9;
+		std::cout << "stage " << stats.name << " threads=" << stats.threads << " deals=" << stats.deals << " busySeconds=" << busySeconds
+				  << " deals/s=" << (wallSeconds > 0.0 ? stats.deals / wallSeconds : 0.0)
+				  << " deals/s/thread=" << (busySeconds > 0.0 ? stats.deals / busySeconds : 0.0)
+				  << " utilisation=" << (wallSeconds > 0.0 ? busySeconds / (wallSeconds * stats.threads) : 0.0) << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!parseOptions(argc, argv, options))
+		{
+			printUsage();
+			return -1;
+		}
+	}
+	catch (const std::exception&)
+	{
+		printUsage();
+		return -1;
+	}
+
+	// dealing and features are cheap, the solver gets most of the cores
+	size_t cores = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+	StageStats dealStats, featureStats, solveStats;
+	dealStats.name = "deal";
+	featureStats.name = "features";
+	solveStats.name = "solve";
+	dealStats.threads = std::max<size_t>(1, cores / 8);
+	featureStats.threads = std::max<size_t>(1, cores / 8);
+	solveStats.threads = options.solve ? std::max<size_t>(1, cores - std::min(cores, dealStats.threads + featureStats.threads)) : 0;
+
+	BoundedQueue<Batch> dealt(options.queueBatches);
+	BoundedQueue<Batch> featured(options.queueBatches);
+	BoundedQueue<Batch> solved(options.queueBatches);
+	BoundedQueue<Batch>& rated = options.solve ? solved : featured;
+
+	DealRating::Table table;
+	table.firstSeed = options.firstSeed;
+	table.drawCount = static_cast<uint8_t>(options.drawCount);
+	table.solved = options.solve;
+	table.resize(options.deals);
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> threads;
+
+	std::atomic<size_t> nextOffset{0};
+	auto nextBatch = [&options, &nextOffset]() -> std::optional<Batch> {
+		size_t offset = nextOffset.fetch_add(options.batchSize);
+		if (offset >= options.deals)
+			return std::nullopt;
+		Batch batch;
+		batch.offset = offset;
+		return batch;
+	};
+	auto deal = [&options](Batch& batch) {
+		size_t count = std::min(options.batchSize, options.deals - batch.offset);
+		batch.games.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			batch.games.push_back(Game::createRandomGame(options.firstSeed + static_cast<unsigned int>(batch.offset + i)));
+			batch.games.back().setDrawCount(options.drawCount);
+		}
+	};
+	for (std::thread& thread : startStage(dealStats, nextBatch, deal, dealt))
+		threads.push_back(std::move(thread));
+
+	auto features = [](Batch& batch) {
+		for (const Game& game : batch.games)
+			batch.features.push_back(DealRating::extractFeatures(game));
+	};
+	for (std::thread& thread : startStage(featureStats, [&dealt]() { return dealt.pop(); }, features, featured))
+		threads.push_back(std::move(thread));
+
+	if (options.solve)
+	{
+		// a node budget and no deadline keeps the file the same for any machine and thread count
+		Solver::Limits limits;
+		limits.maxNodes = options.maxNodes;
+		limits.maxTime = std::chrono::hours(1);
+		auto solve = [limits](Batch& batch) {
+			for (const Game& game : batch.games)
+			{
+				Solver solver(limits);
+				Solver::Solution solution = solver.solve(game);
+				batch.results.push_back(static_cast<uint8_t>(solution.result));
+				batch.nodes.push_back(static_cast<uint32_t>(solution.nodes));
+			}
+		};
+		for (std::thread& thread : startStage(solveStats, [&featured]() { return featured.pop(); }, solve, solved))
+			threads.push_back(std::move(thread));
+	}
+
+	// the last stage writes the columns on this thread, batches arrive in any order
+	StageStats writeStats;
+	writeStats.name = "write";
+	writeStats.threads = 1;
+	while (std::optional<Batch> batch = rated.pop())
+	{
+		auto writeStart = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < batch->games.size(); ++i)
+		{
+			size_t index = batch->offset + i;
+			const DealRating::Features& features = batch->features[i];
+			table.seeds[index] = options.firstSeed + static_cast<uint32_t>(index);
+			table.buriedAces[index] = features.buriedAces;
+			table.closedAboveKings[index] = features.closedAboveKings;
+			table.stockPlayable[index] = features.stockPlayable;
+			table.openingMoves[index] = features.openingMoves;
+
+			std::optional<Solver::Result> result;
+			if (options.solve)
+			{
+				result = static_cast<Solver::Result>(batch->results[i]);
+				table.results[index] = batch->results[i];
+				table.nodes[index] = batch->nodes[i];
+			}
+			table.scores[index] = DealRating::score(features, result, table.nodes[index]);
+		}
+		writeStats.deals += batch->games.size();
+		writeStats.busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - writeStart).count();
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	auto writeStart = std::chrono::steady_clock::now();
+	table.classify();
+	std::filesystem::create_directories(std::filesystem::absolute(options.outPath).parent_path());
+	if (!table.save(options.outPath))
+	{
+		std::cerr << "Could not write " << options.outPath << std::endl;
+		return -1;
+	}
+	writeStats.busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - writeStart).count();
+	double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (const StageStats* stats : {&dealStats, &featureStats, &solveStats, &writeStats})
+	{
+		if (stats->threads != 0)
+			printStage(*stats, wallSeconds);
+	}
+
+	std::array<size_t, 3> counts{};
+	for (Difficulty difficulty : table.difficulties)
+		++counts[static_cast<size_t>(difficulty)];
+	std::cout << "rated deals=" << table.size() << " wallSeconds=" << wallSeconds << " deals/s=" << table.size() / wallSeconds;
+	for (size_t i = 0; i < counts.size(); ++i)
+		std::cout << " " << DealRating::difficultyName(static_cast<Difficulty>(i)) << "=" << counts[i];
+	std::cout << "\nwritten to " << options.outPath.string() << std::endl;
+	return 0;
+}
@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Scripted clients for soliterminal-server: many connections play the same keys, and the time to the answering frame is measured
+// Spectators can watch one of the games meanwhile, the time until their copy of the frame arrives is measured the same way
+
+namespace
+{
+	struct Options
+	{
+		uint16_t port = 2323;
+		std::string unixPath;
+		size_t clients = 100;
+		std::string keys = "rl";
+		size_t rounds = 10;
+		size_t holdSeconds = 0;
+		uint16_t watchPort = 0;
+		size_t viewers = 0;
+		size_t stalled = 0;
+		std::string watch;    // session id the spectators pick, empty for the oldest
+		std::chrono::milliseconds replyTimeout{500};    // keys that change nothing get no answer
+	};
+
+	struct Client
+	{
+		int fd = -1;
+		size_t bytes = 0;
+		bool waiting = false;
+		bool viewer = false;
+		std::chrono::steady_clock::time_point sent;
+	};
+
+	void printUsage()
+	{
+		std::cout << "Usage: soliterminal-loadclient [options]\n"
+				  << "  --port N           loopback TCP port of the server (default 2323)\n"
+				  << "  --unix PATH        connect to the Unix socket instead\n"
+				  << "  --clients N        connections to open (default 100)\n"
+				  << "  --keys K           keys every client sends in turn: u d l r arrows, s space, h hint, e escape (default rl)\n"
+				  << "  --rounds R         times the keys are played (default 10)\n"
+				  << "  --hold S           keep the connections open S seconds after playing, to watch the server memory\n"
+				  << "  --watch-port N     loopback TCP port of the spectators (default 0, no spectators)\n"
+				  << "  --viewers N        spectators watching one of the games while the keys are played (default 0)\n"
+				  << "  --stalled N        spectators more that watch but never read, the server has to skip their frames (default 0)\n"
+				  << "  --watch ID         session id the spectators pick (default the oldest)\n";
+	}
+
+	bool parseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--help" || i + 1 >= argc)
+				return false;
+
+			std::string value = argv[++i];
+			if (arg == "--port")
+				options.port = static_cast<uint16_t>(std::stoul(value));
+			else if (arg == "--unix")
+				options.unixPath = value;
+			else if (arg == "--clients")
+				options.clients = std::stoul(value);
+			else if (arg == "--keys")
+				options.keys = value;
+			else if (arg == "--rounds")
+				options.rounds = std::stoul(value);
+			else if (arg == "--hold")
+				options.holdSeconds = std::stoul(value);
+			else if (arg == "--watch-port")
+				options.watchPort = static_cast<uint16_t>(std::stoul(value));
+			else if (arg == "--viewers")
+				options.viewers = std::stoul(value);
+			else if (arg == "--stalled")
+				options.stalled = std::stoul(value);
+			else if (arg == "--watch")
+				options.watch = value;
+			else
+				return false;
+		}
+		return true;
+	}
+
+	std::string keyBytes(char key)
+	{
+		switch (key)
+		{
+		case 'u':
+			return "\x1b[A";
+		case 'd':
+			return "\x1b[B";
+		case 'r':
+			return "\x1b[C";
+		case 'l':
+			return "\x1b[D";
+		case 's':
+			return " ";
+		case 'e':
+			return "\x1b";
+		default:
+			return std::string(1, key);
+		}
+	}
+
+	int connectClient(const Options& options, bool viewer)
+	{
+		int fd = -1;
+		if (options.unixPath.empty() || viewer)
+		{
+			fd = socket(AF_INET, SOCK_STREAM, 0);
+			sockaddr_in address{};
+			address.sin_family = AF_INET;
+			address.sin_port = htons(viewer ? options.watchPort : options.port);
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+			{
+				if (fd >= 0)
+					close(fd);
+				return -1;
+			}
+		}
+		else
+		{
+			fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			sockaddr_un address{};
+			address.sun_family = AF_UNIX;
+			options.unixPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+			if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+			{
+				if (fd >= 0)
+					close(fd);
+				return -1;
+			}
+		}
+		return fd;
+	}
+
+	// Reads until every waiting client got an answer or the timeout passed, returns the latency of every answer to a player in microseconds
+	// The latencies of the spectators go to viewerLatencies
+	std::vector<double> collect(int epoll, std::vector<Client>& clients, std::chrono::milliseconds timeout, std::vector<double>* viewerLatencies = nullptr)
+	{
+		std::vector<double> latencies;
+		size_t waiting = std::count_if(clients.begin(), clients.end(), [](const Client& client) { return client.waiting; });
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		std::vector<epoll_event> events(256);
+		char buffer[16384];
+		while (waiting > 0 && std::chrono::steady_clock::now() < deadline)
+		{
+			int count = epoll_wait(epoll, events.data(), static_cast<int>(events.size()), 10);
+			auto now = std::chrono::steady_clock::now();
+			for (int i = 0; i < count; ++i)
+			{
+				Client& client = clients[events[i].data.u32];
+				ssize_t bytes = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+				if (bytes == 0)
+				{
+					// a closed connection stays readable, it is no longer watched and gets no answer
+					epoll_ctl(epoll, EPOLL_CTL_DEL, client.fd, nullptr);
+					if (client.waiting)
+					{
+						client.waiting = false;
+						--waiting;
+					}
+					continue;
+				}
+				if (bytes < 0)
+					continue;
+				client.bytes += static_cast<size_t>(bytes);
+				if (client.waiting)
+				{
+					client.waiting = false;
+					--waiting;
+					double latency = std::chrono::duration<double, std::micro>(now - client.sent).count();
+					if (!client.viewer)
+						latencies.push_back(latency);
+					else if (viewerLatencies)
+						viewerLatencies->push_back(latency);
+				}
+			}
+		}
+
+		// the rest of a frame split over several reads belongs to this key, not the next one
+		int count = 0;
+		while ((count = epoll_wait(epoll, events.data(), static_cast<int>(events.size()), 1)) > 0)
+		{
+			for (int i = 0; i < count; ++i)
+			{
+				Client& client = clients[events[i].data.u32];
+				ssize_t bytes = recv(client.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+				if (bytes > 0)
+					client.bytes += static_cast<size_t>(bytes);
+				else if (bytes == 0)
+					epoll_ctl(epoll, EPOLL_CTL_DEL, client.fd, nullptr);
+			}
+		}
+		return latencies;
+	}
+
+	double percentile(std::vector<double> values, double fraction)
+	{
+		if (values.empty())
+			return 0.0;
+		std::sort(values.begin(), values.end());
+		return values[std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()))];
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!parseOptions(argc, argv, options))
+		{
+			printUsage();
+			return -1;
+		}
+	}
+	catch (const std::exception&)
+	{
+		printUsage();
+		return -1;
+	}
+
+	rlimit limit;
+	if (getrlimit(RLIMIT_NOFILE, &limit) == 0)
+	{
+		limit.rlim_cur = limit.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &limit);
+	}
+
+	int epoll = epoll_create1(0);
+	std::vector<Client> clients;
+	auto connectStart = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < options.clients; ++i)
+	{
+		Client client;
+		client.fd = connectClient(options, false);
+		if (client.fd < 0)
+		{
+			std::cout << "connection " << i << " failed: " << strerror(errno) << std::endl;
+			break;
+		}
+		client.waiting = true;    // for the first frame
+		client.sent = std::chrono::steady_clock::now();
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.u32 = static_cast<uint32_t>(clients.size());
+		epoll_ctl(epoll, EPOLL_CTL_ADD, client.fd, &event);
+		clients.push_back(client);
+	}
+	std::vector<double> firstFrames = collect(epoll, clients, options.replyTimeout);
+	double connectSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - connectStart).count();
+	std::cout << "connected=" << clients.size() << " firstFrames=" << firstFrames.size() << " seconds=" << connectSeconds << std::endl;
+	size_t players = clients.size();
+
+	// spectators answer the prompt once it arrived, the stalled ones are never read from again
+	std::vector<int> stalled;
+	if (options.watchPort != 0 && options.viewers + options.stalled > 0)
+	{
+		std::string choice = options.watch + "\r";
+		for (size_t i = 0; i < options.viewers + options.stalled; ++i)
+		{
+			Client client;
+			client.fd = connectClient(options, true);
+			if (client.fd < 0)
+			{
+				std::cout << "spectator " << i << " failed: " << strerror(errno) << std::endl;
+				break;
+			}
+			if (i >= options.viewers)
+			{
+				[[maybe_unused]] ssize_t written = send(client.fd, choice.data(), choice.size(), MSG_NOSIGNAL);
+				stalled.push_back(client.fd);
+				continue;
+			}
+			client.waiting = true;
+			client.viewer = true;
+			epoll_event event{};
+			event.events = EPOLLIN;
+			event.data.u32 = static_cast<uint32_t>(clients.size());
+			epoll_ctl(epoll, EPOLL_CTL_ADD, client.fd, &event);
+			clients.push_back(client);
+		}
+		collect(epoll, clients, options.replyTimeout);
+		std::vector<double> keyframes;
+		for (size_t i = players; i < clients.size(); ++i)
+		{
+			clients[i].sent = std::chrono::steady_clock::now();
+			clients[i].waiting = send(clients[i].fd, choice.data(), choice.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(choice.size());
+		}
+		collect(epoll, clients, options.replyTimeout, &keyframes);
+		std::cout << "viewers=" << clients.size() - players << " stalled=" << stalled.size() << " keyframes=" << keyframes.size()
+				  << " keyframeP50Us=" << percentile(keyframes, 0.5) << std::endl;
+	}
+
+	std::vector<double> latencies;
+	std::vector<double> viewerLatencies;
+	size_t sent = 0;
+	size_t before = 0;
+	size_t viewerBefore = 0;
+	for (const Client& client : clients)
+		(client.viewer ? viewerBefore : before) += client.bytes;
+	auto playStart = std::chrono::steady_clock::now();
+	for (size_t round = 0; round < options.rounds; ++round)
+	{
+		for (char key : options.keys)
+		{
+			std::string bytes = keyBytes(key);
+			for (Client& client : clients)
+			{
+				client.sent = std::chrono::steady_clock::now();
+				if (client.viewer)
+				{
+					client.waiting = true;    // for the frame of the game it watches
+					continue;
+				}
+				client.waiting = send(client.fd, bytes.data(), bytes.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(bytes.size());
+				sent++;
+			}
+			std::vector<double> answered = collect(epoll, clients, options.replyTimeout, &viewerLatencies);
+			latencies.insert(latencies.end(), answered.begin(), answered.end());
+		}
+	}
+	double playSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - playStart).count();
+	size_t received = 0;
+	size_t viewerReceived = 0;
+	for (const Client& client : clients)
+		(client.viewer ? viewerReceived : received) += client.bytes;
+	received -= before;
+	viewerReceived -= viewerBefore;
+
+	double average = 0.0;
+	for (double latency : latencies)
+		average += latency;
+	average = latencies.empty() ? 0.0 : average / latencies.size();
+	std::cout << "keys=" << sent << " answered=" << latencies.size() << " keys/s=" << (playSeconds > 0.0 ? sent / playSeconds : 0.0)
+			  << " avgUs=" << average << " p50Us=" << percentile(latencies, 0.5) << " p99Us=" << percentile(latencies, 0.99)
+			  << " bytesPerKey=" << (sent > 0 ? static_cast<double>(received) / sent : 0.0) << std::endl;
+	size_t viewers = clients.size() - players;
+	if (viewers > 0)
+	{
+		// every spectator sees one frame per key played in the game it watches
+		size_t watchedKeys = players > 0 ? sent / players : 0;
+		std::cout << "viewerFrames=" << viewerLatencies.size() << " viewerP50Us=" << percentile(viewerLatencies, 0.5)
+				  << " viewerP99Us=" << percentile(viewerLatencies, 0.99)
+				  << " viewerBytesPerKey=" << (watchedKeys > 0 ? static_cast<double>(viewerReceived) / (watchedKeys * viewers) : 0.0) << std::endl;
+	}
+
+	if (options.holdSeconds > 0)
+		std::this_thread::sleep_for(std::chrono::seconds(options.holdSeconds));
+
+	for (const Client& client : clients)
+		close(client.fd);
+	for (int fd : stalled)
+		close(fd);
+	close(epoll);
+	return 0;
+}
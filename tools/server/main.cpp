@@ -0,0 +1,153 @@
+#include "Server.h"
+
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+using namespace panda;
+
+namespace
+{
+	Server* runningServer = nullptr;
+
+	void onSignal(int)
+	{
+		if (runningServer)
+			runningServer->stop();
+	}
+
+	// resident memory of the process, from /proc
+	size_t residentBytes()
+	{
+		std::ifstream statm("/proc/self/statm");
+		size_t pages = 0;
+		size_t resident = 0;
+		statm >> pages >> resident;
+		return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	}
+
+	void printUsage()
+	{
+		std::cout << "Usage: soliterminal-server [options]\n"
+				  << "  --port N           loopback TCP port to accept telnet connections on, 0 for none (default 2323)\n"
+				  << "  --unix PATH        Unix socket to accept connections on\n"
+				  << "  --watch-port N     loopback TCP port for spectators to watch sessions on, 0 for none (default 0)\n"
+				  << "  --size WxH         terminal size of every session (default 80x40)\n"
+				  << "  --max-sessions N   connections beyond this are refused (default 10000)\n"
+				  << "  --report S         print sessions, traffic and memory every S seconds (default 5, 0 for never)\n";
+	}
+
+	bool parseOptions(int argc, char** argv, Server::Config& config)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--help" || i + 1 >= argc)
+				return false;
+
+			std::string value = argv[++i];
+			if (arg == "--port")
+			{
+				config.port = static_cast<uint16_t>(std::stoul(value));
+			}
+			else if (arg == "--unix")
+			{
+				config.unixPath = value;
+			}
+			else if (arg == "--watch-port")
+			{
+				config.watchPort = static_cast<uint16_t>(std::stoul(value));
+			}
+			else if (arg == "--size")
+			{
+				size_t separator = value.find('x');
+				if (separator == std::string::npos)
+					return false;
+				config.width = std::stoi(value.substr(0, separator));
+				config.height = std::stoi(value.substr(separator + 1));
+			}
+			else if (arg == "--max-sessions")
+			{
+				config.maxSessions = std::stoul(value);
+			}
+			else if (arg == "--report")
+			{
+				config.reportInterval = std::chrono::seconds(std::stoul(value));
+			}
+			else
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Server::Config config;
+	config.reportInterval = std::chrono::seconds(5);
+	try
+	{
+		if (!parseOptions(argc, argv, config))
+		{
+			printUsage();
+			return -1;
+		}
+	}
+	catch (const std::exception&)
+	{
+		printUsage();
+		return -1;
+	}
+
+	// the memory of the process without sessions, so the report can tell what each session costs
+	size_t baseBytes = residentBytes();
+	config.report = [baseBytes](const Server::Stats& stats) {
+		size_t bytes = residentBytes();
+		std::cout << "sessions=" << stats.sessions << " activeSessions=" << stats.activeSessions << " peakSessions=" << stats.peakSessions
+				  << " bytesSent=" << stats.bytesSent << " residentMB=" << bytes / (1024.0 * 1024.0);
+		if (stats.sessions > 0 && bytes > baseBytes)
+			std::cout << " bytesPerSession=" << (bytes - baseBytes) / stats.sessions;
+		if (stats.sessions > 0)
+			std::cout << " arenaBytesPerSession=" << stats.arenaBytes / stats.sessions << " overflowBytes=" << stats.overflowBytes;
+		if (stats.peakViewers > 0)
+			std::cout << " viewers=" << stats.viewers << " framesBroadcast=" << stats.framesBroadcast << " bytesBroadcast=" << stats.bytesBroadcast
+					  << " viewerSkips=" << stats.viewerSkips;
+		std::cout << std::endl;
+	};
+
+	try
+	{
+		Server server(config);
+		runningServer = &server;
+		std::signal(SIGINT, onSignal);
+		std::signal(SIGTERM, onSignal);
+
+		std::cout << "listening";
+		if (config.port != 0)
+			std::cout << " on 127.0.0.1:" << config.port;
+		if (!config.unixPath.empty())
+			std::cout << " on " << config.unixPath;
+		if (config.watchPort != 0)
+			std::cout << ", spectators on 127.0.0.1:" << config.watchPort;
+		std::cout << std::endl;
+
+		server.run();
+		runningServer = nullptr;
+
+		const Server::Stats& stats = server.stats();
+		std::cout << "accepted=" << stats.accepted << " peakSessions=" << stats.peakSessions << " bytesReceived=" << stats.bytesReceived
+				  << " bytesSent=" << stats.bytesSent << " peakViewers=" << stats.peakViewers << " bytesBroadcast=" << stats.bytesBroadcast
+				  << " viewerSkips=" << stats.viewerSkips << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cout << "Unexpected error: " << e.what() << std::endl;
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,322 @@
+#include "Simulation.h"
+#include "VecEnv.h"
+#include "WinEstimate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace panda;
+
+namespace
+{
+	struct Options
+	{
+		std::vector<std::string> policies = {"random", "greedy", "solver"};
+		Simulation::Config config;
+		std::string csvPath;
+		std::string jsonPath;
+		bool scaling = false;
+		bool freeCell = false;
+		size_t envs = 0;       // steps a VecEnv of this many games instead of playing policies
+		size_t steps = 1000;
+		size_t estimateMilliseconds = 0;    // estimates the win chance of every deal instead of playing it
+	};
+
+	void printUsage()
+	{
+		std::cout << "Usage: soliterminal-sim [options]\n"
+				  << "  --games N          number of deals to play per policy (default 1000)\n"
+				  << "  --seed S           seed of the first deal, deals use consecutive seeds (default 1)\n"
+				  << "  --threads T        worker threads, 0 uses all cores (default 0)\n"
+				  << "  --max-moves M      moves after which a game counts as lost (default 1000)\n"
+				  << "  --policy P[,P..]   policies to play: random, greedy, solver (default all)\n"
+				  << "  --csv FILE         write one row per played game\n"
+				  << "  --json FILE        write the summary of every run\n"
+				  << "  --scaling          repeat each policy with 1, 2, 4.. threads up to --threads\n"
+				  << "  --draw N           cards opened on each draw, 1 or 3 (default 1)\n"
+				  << "  --auto-play        move safe cards to the end stacks after every move\n"
+				  << "  --freecell         solve the numbered FreeCell deals from --seed instead, e.g. --seed 1 --games 32000\n"
+				  << "  --envs N           step N reinforcement learning envs with random legal actions instead, and report steps per second\n"
+				  << "  --steps S          steps of every env with --envs (default 1000)\n"
+				  << "  --estimate MS      estimate the chance to win of every deal in MS milliseconds, sampling its closed cards\n";
+	}
+
+	std::vector<std::string> split(const std::string& str, char separator)
+	{
+		std::vector<std::string> out;
+		std::stringstream stream(str);
+		std::string item;
+		while (std::getline(stream, item, separator))
+		{
+			if (!item.empty())
+				out.push_back(item);
+		}
+		return out;
+	}
+
+	bool parseOptions(int argc, char** argv, Options& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if (arg == "--scaling")
+			{
+				options.scaling = true;
+				continue;
+			}
+			if (arg == "--auto-play")
+			{
+				options.config.autoPlay = true;
+				continue;
+			}
+			if (arg == "--freecell")
+			{
+				options.freeCell = true;
+				continue;
+			}
+			if (arg == "--help" || i + 1 >= argc)
+				return false;
+
+			std::string value = argv[++i];
+			if (arg == "--games")
+				options.config.games = std::stoul(value);
+			else if (arg == "--seed")
+				options.config.firstSeed = static_cast<unsigned int>(std::stoul(value));
+			else if (arg == "--threads")
+				options.config.threads = std::stoul(value);
+			else if (arg == "--max-moves")
+				options.config.maxMoves = std::stoul(value);
+			else if (arg == "--draw")
+				options.config.drawCount = std::stoul(value);
+			else if (arg == "--policy")
+				options.policies = split(value, ',');
+			else if (arg == "--csv")
+				options.csvPath = value;
+			else if (arg == "--json")
+				options.jsonPath = value;
+			else if (arg == "--envs")
+				options.envs = std::stoul(value);
+			else if (arg == "--steps")
+				options.steps = std::stoul(value);
+			else if (arg == "--estimate")
+				options.estimateMilliseconds = std::stoul(value);
+			else
+				return false;
+		}
+		return true;
+	}
+
+	std::vector<size_t> threadCounts(const Options& options)
+	{
+		size_t maxThreads = options.config.threads;
+		if (maxThreads == 0)
+			maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		if (!options.scaling)
+			return {maxThreads};
+
+		std::vector<size_t> counts;
+		for (size_t count = 1; count < maxThreads; count *= 2)
+			counts.push_back(count);
+		counts.push_back(maxThreads);
+		return counts;
+	}
+
+	void writeCsv(const std::string& path, const std::vector<Simulation::Report>& reports)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "Could not open " << path << std::endl;
+			return;
+		}
+
+		file << "policy,threads,seed,won,moves,microseconds\n";
+		for (const auto& report : reports)
+		{
+			for (const auto& result : report.results)
+			{
+				file << report.policy << ',' << report.threads << ',' << result.seed << ',' << result.won << ',' << result.moves << ','
+					 << result.microseconds << '\n';
+			}
+		}
+	}
+
+	void writeJson(const std::string& path, const std::vector<Simulation::Report>& reports, const std::vector<double>& efficiencies)
+	{
+		std::ofstream file(path);
+		if (!file.is_open())
+		{
+			std::cerr << "Could not open " << path << std::endl;
+			return;
+		}
+
+		file << "{\n  \"runs\": [\n";
+		for (size_t i = 0; i < reports.size(); ++i)
+		{
+			const auto& report = reports[i];
+			file << "    {\"policy\": \"" << report.policy << "\", \"threads\": " << report.threads << ", \"games\": " << report.results.size()
+				 << ", \"wins\": " << report.wins() << ", \"winRate\": " << report.winRate() << ", \"averageMoves\": " << report.averageMoves()
+				 << ", \"averageMicroseconds\": " << report.averageMicroseconds() << ", \"wallSeconds\": " << report.wallSeconds
+				 << ", \"gamesPerSecond\": " << report.gamesPerSecond() << ", \"totalSeconds\": " << report.totalSeconds() << ", \"scalingEfficiency\": ";
+			if (efficiencies[i] >= 0.0)
+				file << efficiencies[i];
+			else
+				file << "null";
+			file << "}"
+				 << (i + 1 < reports.size() ? "," : "") << "\n";
+		}
+		file << "  ]\n}\n";
+	}
+
+	// Steps the envs with random legal actions, only the time spent in VecEnv::step counts for the steps per second
+	void runVecEnv(const Options& options, size_t threads)
+	{
+		VecEnv::Config config;
+		config.envs = options.envs;
+		config.firstSeed = options.config.firstSeed;
+		config.threads = threads;
+		config.drawCount = options.config.drawCount;
+		config.autoPlay = options.config.autoPlay;
+		config.maxSteps = options.config.maxMoves;
+		VecEnv env(config);
+
+		std::vector<uint8_t> observations(config.envs * VecEnv::observationSize);
+		std::vector<uint8_t> masks(config.envs * VecEnv::actionCount);
+		std::vector<float> rewards(config.envs);
+		std::vector<uint8_t> dones(config.envs);
+		std::vector<uint32_t> actions(config.envs);
+		std::vector<uint32_t> legal;
+		VecEnv::Buffers buffers{observations.data(), masks.data(), rewards.data(), dones.data()};
+		env.reset(buffers);
+
+		std::mt19937 rng(config.firstSeed);
+		std::chrono::duration<double> stepTime{0};
+		for (size_t step = 0; step < options.steps; ++step)
+		{
+			for (size_t i = 0; i < config.envs; ++i)
+			{
+				legal.clear();
+				const uint8_t* mask = &masks[i * VecEnv::actionCount];
+				for (uint32_t action = 0; action < VecEnv::actionCount; ++action)
+				{
+					if (mask[action])
+						legal.push_back(action);
+				}
+				actions[i] = legal.empty() ? 0 : legal[std::uniform_int_distribution<size_t>(0, legal.size() - 1)(rng)];
+			}
+
+			auto start = std::chrono::steady_clock::now();
+			env.step(actions.data(), buffers);
+			stepTime += std::chrono::steady_clock::now() - start;
+		}
+
+		VecEnv::Stats stats = env.stats();
+		std::cout << "vecenv threads=" << threads << " envs=" << config.envs << " steps=" << stats.steps << " episodes=" << stats.episodes
+				  << " wins=" << stats.wins << " illegal=" << stats.illegalActions << " stepSeconds=" << stepTime.count()
+				  << " steps/s=" << (stepTime.count() > 0.0 ? stats.steps / stepTime.count() : 0.0) << std::endl;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	try
+	{
+		if (!parseOptions(argc, argv, options))
+		{
+			printUsage();
+			return -1;
+		}
+	}
+	catch (const std::exception&)
+	{
+		printUsage();
+		return -1;
+	}
+
+	if (options.estimateMilliseconds > 0)
+	{
+		WinEstimate::Config config;
+		config.policy = options.policies.size() == 1 ? options.policies.front() : "greedy";
+		config.budget = std::chrono::milliseconds(options.estimateMilliseconds);
+		config.threads = options.config.threads;
+		config.maxMoves = options.config.maxMoves;
+		for (size_t i = 0; i < options.config.games; ++i)
+		{
+			unsigned int seed = options.config.firstSeed + static_cast<unsigned int>(i);
+			Game game = Game::createRandomGame(seed);
+			game.setDrawCount(options.config.drawCount);
+			game.setAutoPlay(options.config.autoPlay);
+			WinEstimate::Estimate estimate = WinEstimate::estimate(game, config);
+			std::cout << "seed=" << seed << " policy=" << config.policy << " samples=" << estimate.samples << " winChance=" << estimate.probability
+					  << " low=" << estimate.low << " high=" << estimate.high << " samples/s=" << estimate.samples / estimate.seconds << std::endl;
+		}
+		return 0;
+	}
+
+	if (options.envs > 0)
+	{
+		for (size_t threads : threadCounts(options))
+			runVecEnv(options, threads);
+		return 0;
+	}
+
+	// FreeCell deals are only solved, not played by a policy
+	if (options.freeCell)
+		options.policies = {"freecell"};
+
+	std::vector<Simulation::Report> reports;
+	std::vector<double> efficiencies;
+
+	try
+	{
+		for (const auto& policy : options.policies)
+		{
+			double singleThreadRate = 0.0;
+			for (size_t threads : threadCounts(options))
+			{
+				Simulation::Config config = options.config;
+				config.policy = policy;
+				config.threads = threads;
+				Simulation::Report report = options.freeCell ? Simulation::solveFreeCell(config) : Simulation::run(config);
+
+				// efficiency compares against a perfect linear speedup of the single thread run
+				if (threads == 1)
+					singleThreadRate = report.gamesPerSecond();
+				// without a single thread run there is nothing to compare against, reported as negative
+				double efficiency = singleThreadRate > 0.0 ? report.gamesPerSecond() / (singleThreadRate * report.threads) : -1.0;
+
+				std::cout << policy << " threads=" << report.threads << " games=" << report.results.size() << " wins=" << report.wins()
+						  << " winRate=" << report.winRate() << " avgMoves=" << report.averageMoves() << " avgUs=" << report.averageMicroseconds()
+						  << " games/s=" << report.gamesPerSecond() << " totalSeconds=" << report.totalSeconds() << " wallSeconds=" << report.wallSeconds;
+				if (efficiency >= 0.0)
+					std::cout << " efficiency=" << efficiency;
+				std::cout << std::endl;
+
+				reports.push_back(std::move(report));
+				efficiencies.push_back(efficiency);
+			}
+		}
+	}
+	catch (const std::invalid_argument& e)
+	{
+		std::cout << e.what() << std::endl;
+		printUsage();
+		return -1;
+	}
+
+	if (!options.csvPath.empty())
+		writeCsv(options.csvPath, reports);
+	if (!options.jsonPath.empty())
+		writeJson(options.jsonPath, reports, efficiencies);
+
+	return 0;
+}
\ No newline at end of file